@@ -48,6 +48,8 @@ enum {
 About::About()
   : Dialog(IDD_ABOUT_DIALOG)
 {
+  // the dialog template contains a rich edit control
+  RichEdit::Init();
 }
 
 void About::onInit()
@@ -46,6 +46,7 @@ namespace API {
   extern APIFunc BrowsePackages;
   extern APIFunc CompareVersions;
   extern APIFunc ProcessQueue;
+  extern APIFunc VerifyInstallation;
 
   // api_package.cpp
   extern APIFunc AboutInstalledPackage;
@@ -53,6 +54,7 @@ namespace API {
   extern APIFunc FreeEntry;
   extern APIFunc GetEntryInfo;
   extern APIFunc GetOwner;
+  extern APIFunc SearchPackages;
 
   // api_repo.cpp
   extern APIFunc AboutRepository;
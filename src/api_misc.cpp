@@ -51,3 +51,11 @@ R"(Run pending operations and save the configuration file. If refreshUI is true
 {
   g_reapack->commitConfig(refreshUI);
 });
+
+DEFINE_API(bool, VerifyInstallation, ((bool, repair)),
+R"(Check that the files of the installed packages still match what was installed, rehashing them in the background. Modified and missing files are listed in the report. If repair is true, only those files are downloaded again.
+
+Returns false if the operation could not be started.)",
+{
+  return g_reapack->verifyInstallation(repair);
+});
@@ -19,13 +19,18 @@
 #include "api_helper.hpp"
 
 #include "about.hpp"
+#include "config.hpp"
 #include "errors.hpp"
 #include "index.hpp"
+#include "indexcache.hpp"
 #include "reapack.hpp"
 #include "registry.hpp"
 #include "remote.hpp"
+#include "searchindex.hpp"
 #include "transaction.hpp"
 
+#include <algorithm>
+
 using namespace std;
 
 struct PackageEntry {
@@ -35,6 +40,41 @@ struct PackageEntry {
 
 static set<PackageEntry *> s_entries;
 
+struct SearchResult {
+  string remote;
+  string category;
+  string package;
+  int score;
+};
+
+static vector<SearchResult> searchPackages(const char *query)
+{
+  vector<SearchResult> results;
+
+  for(const Remote &remote : g_reapack->config()->remotes.getEnabled()) {
+    IndexPtr index;
+
+    try {
+      index = g_reapack->indexCache()->load(remote.name());
+    }
+    catch(const reapack_error &) {
+      continue; // not downloaded yet
+    }
+
+    for(const SearchIndex::Result &result : index->searchIndex().search(query)) {
+      const Package *pkg = result.package;
+      results.push_back({remote.name(), pkg->category()->name(),
+        pkg->name(), result.score});
+    }
+  }
+
+  // equal scores keep the order of the repositories
+  stable_sort(results.begin(), results.end(),
+    [](const SearchResult &a, const SearchResult &b) { return a.score > b.score; });
+
+  return results;
+}
+
 DEFINE_API(bool, AboutInstalledPackage, ((PackageEntry*, entry)),
 R"(Show the about dialog of the given package entry.
 The repository index is downloaded asynchronously if the cached copy doesn't exist or is older than one week.)",
@@ -167,3 +207,39 @@ Delete the returned object from memory after use with <a href="#ReaPack_FreeEntr
     return nullptr;
   }
 });
+
+DEFINE_API(bool, SearchPackages, ((const char*, query))((int, index))
+  ((char*, repoOut))((int, repoOut_sz))((char*, catOut))((int, catOut_sz))
+  ((char*, pkgOut))((int, pkgOut_sz))((int*, scoreOut)),
+R"(Search the packages of the enabled repositories by name, description, category and author. Every word of the query must be found. Results are sorted by relevance (highest score first).
+
+Enumerate the results by calling this function with index 0, 1, 2... The search is run again when index is 0 or when the query changes. Returns false when there are no more results.)",
+{
+  static string s_query;
+  static vector<SearchResult> s_results;
+
+  if(!query || index < 0)
+    return false;
+  else if(index == 0 || s_query != query) {
+    s_query = query;
+    s_results = searchPackages(query);
+  }
+
+  const size_t i = index;
+
+  if(i >= s_results.size())
+    return false;
+
+  const SearchResult &result = s_results[i];
+
+  if(repoOut)
+    snprintf(repoOut, repoOut_sz, "%s", result.remote.c_str());
+  if(catOut)
+    snprintf(catOut, catOut_sz, "%s", result.category.c_str());
+  if(pkgOut)
+    snprintf(pkgOut, pkgOut_sz, "%s", result.package.c_str());
+  if(scoreOut)
+    *scoreOut = result.score;
+
+  return true;
+});
@@ -20,15 +20,20 @@
 #include "config.hpp"
 #include "errors.hpp"
 #include "filesystem.hpp"
+#include "hash.hpp"
 #include "index.hpp"
 #include "path.hpp"
 #include "reapack.hpp"
 #include "transaction.hpp"
 #include "win32.hpp"
 
+#include <array>
+#include <cctype>
+#include <cmath>
 #include <fstream>
 #include <iomanip>
 #include <sstream>
+#include <unordered_set>
 
 #include <zlib/zip.h>
 #include <zlib/unzip.h>
@@ -37,7 +42,25 @@
 using namespace std;
 
 static const Path ARCHIVE_TOC("toc");
-static const size_t BUFFER_SIZE = 4096;
+static const Path ARCHIVE_MANIFEST("manifest");
+static const unsigned int MAX_CHAIN_LENGTH = 100;
+static const size_t BUFFER_SIZE = 256 * 1024;
+static const size_t SPOOL_THRESHOLD = 4 * 1024 * 1024;
+
+static const int STORED = 0; // zip compression method
+
+// files in these formats are already compressed
+static const unordered_set<string> COMPRESSED_EXTS {
+  "7z", "bz2", "flac", "gif", "gz", "jpeg", "jpg", "m4a", "mp3", "ogg",
+  "opus", "png", "reaperthemezip", "webp", "xz", "zip",
+};
+
+// these only shrink a little and are stored when favoring speed
+static const unordered_set<string> POOR_EXTS { "dll", "dylib", "so", "wav" };
+
+// bits per byte above which a sample is considered incompressible
+static const double MAX_ENTROPY = 7.5;
+static const size_t MIN_SAMPLE_SIZE = 4096;
 
 #ifdef _WIN32
 static void *wide_fopen(voidpf, const void *filename, int mode)
@@ -62,6 +85,28 @@ static void *wide_fopen(voidpf, const void *filename, int mode)
 }
 #endif
 
+static zlib_filefunc64_def fileFuncs()
+{
+  zlib_filefunc64_def filefunc;
+  fill_fopen64_filefunc(&filefunc);
+#ifdef _WIN32
+  filefunc.zopen64_file = wide_fopen;
+#endif
+
+  return filefunc;
+}
+
+static string entryKey(string name)
+{
+#ifdef _WIN32
+  // match unzLocateFile's default case sensitivity
+  for(char &c : name)
+    c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+#endif
+
+  return name;
+}
+
 struct ImportArchive {
   void importRemote(const string &);
   void importPackage(const string &);
@@ -132,7 +177,9 @@ void ImportArchive::importRemote(const string &data)
   }
 
   m_remotes->add(remote);
-  m_lastIndex = Index::load(remote.name());
+
+  g_reapack->indexCache()->invalidate(remote.name());
+  m_lastIndex = g_reapack->indexCache()->load(remote.name());
 }
 
 void ImportArchive::importPackage(const string &data)
@@ -163,23 +210,125 @@ void ImportArchive::importPackage(const string &data)
   m_tx->install(ver, pinned, m_reader);
 }
 
-ArchiveReader::ArchiveReader(const Path &path)
+ArchiveReader::ArchiveReader(const Path &path) : ArchiveReader(path, 0)
 {
-  zlib_filefunc64_def filefunc;
-  fill_fopen64_filefunc(&filefunc);
-#ifdef _WIN32
-  filefunc.zopen64_file = wide_fopen;
-#endif
+}
 
-  m_zip = unzOpen2_64(path.join().c_str(), &filefunc);
+ArchiveReader::ArchiveReader(const Path &path, const unsigned int depth)
+  : m_path(path)
+{
+  unzFile zip = open();
 
-  if(!m_zip)
+  if(!zip)
     throw reapack_error(FS::lastError());
+
+  m_handles.push_back(zip);
+
+  // index the central directory once instead of scanning it for every file
+  for(int status = unzGoToFirstFile(zip); status == UNZ_OK;
+      status = unzGoToNextFile(zip)) {
+    unz_file_info64 info;
+    if(unzGetCurrentFileInfo64(zip, &info,
+        nullptr, 0, nullptr, 0, nullptr, 0) != UNZ_OK)
+      break;
+
+    string name(info.size_filename, 0);
+    unz64_file_pos pos;
+    if(unzGetCurrentFileInfo64(zip, nullptr, &name[0], static_cast<uLong>(name.size()),
+        nullptr, 0, nullptr, 0) != UNZ_OK || unzGetFilePos64(zip, &pos) != UNZ_OK)
+      break;
+
+    m_entries.emplace(entryKey(name),
+      Position{pos.pos_in_zip_directory, pos.num_of_file});
+  }
+
+  try {
+    readManifest(depth);
+  }
+  catch(const reapack_error &) {
+    // the destructor won't run
+    for(unzFile handle : m_handles)
+      unzClose(handle);
+
+    throw;
+  }
+}
+
+void ArchiveReader::readManifest(const unsigned int depth)
+{
+  stringstream manifest;
+  if(extractFile(ARCHIVE_MANIFEST, manifest))
+    return; // full archive made by an older version
+
+  string line, baseName;
+  while(getline(manifest, line)) {
+    if(!line.compare(0, 5, "BASE ")) {
+      baseName = line.substr(5);
+      continue;
+    }
+
+    const size_t tab = line.find('\t');
+    if(tab != string::npos)
+      m_checksums[line.substr(tab + 1)] = line.substr(0, tab);
+  }
+
+  if(baseName.empty())
+    return;
+  else if(baseName.find_first_of("/\\") != string::npos ||
+      baseName.find("..") != string::npos)
+    throw reapack_error("Invalid base archive name: " + baseName);
+  else if(depth >= MAX_CHAIN_LENGTH)
+    throw reapack_error("Too many incremental archives in the chain");
+
+  // the base archive is expected to be stored next to the incremental one
+  const Path basePath = m_path.dirname() + baseName;
+
+  try {
+    m_base.reset(new ArchiveReader(basePath, depth + 1));
+  }
+  catch(const reapack_error &e) {
+    throw reapack_error(String::format("Cannot open base archive %s (%s)",
+      basePath.join().c_str(), e.what()));
+  }
+}
+
+const string *ArchiveReader::checksum(const Path &path) const
+{
+  const auto it = m_checksums.find(path.join(false));
+  return it == m_checksums.end() ? nullptr : &it->second;
 }
 
 ArchiveReader::~ArchiveReader()
 {
-  unzClose(m_zip);
+  for(unzFile zip : m_handles)
+    unzClose(zip);
+}
+
+unzFile ArchiveReader::open() const
+{
+  zlib_filefunc64_def filefunc = fileFuncs();
+  return unzOpen2_64(m_path.join().c_str(), &filefunc);
+}
+
+unzFile ArchiveReader::acquire() noexcept
+{
+  {
+    lock_guard<mutex> guard(m_mutex);
+
+    if(!m_handles.empty()) {
+      unzFile zip = m_handles.back();
+      m_handles.pop_back();
+      return zip;
+    }
+  }
+
+  return open();
+}
+
+void ArchiveReader::release(unzFile zip) noexcept
+{
+  lock_guard<mutex> guard(m_mutex);
+  m_handles.push_back(zip);
 }
 
 int ArchiveReader::extractFile(const Path &path)
@@ -196,28 +345,52 @@ int ArchiveReader::extractFile(const Path &path)
 
 int ArchiveReader::extractFile(const Path &path, ostream &stream) noexcept
 {
-  int status = unzLocateFile(m_zip, path.join(false).c_str(), false);
-  if(status != UNZ_OK)
-    return status;
+  const string &name = path.join(false);
+  const auto it = m_entries.find(entryKey(name));
+
+  if(it == m_entries.end()) {
+    // only files listed in the manifest were left for the base to provide,
+    // others failed to be exported
+    if(m_base && m_checksums.count(name))
+      return m_base->extractFile(path, stream);
+
+    return UNZ_END_OF_LIST_OF_FILE;
+  }
 
-  status = unzOpenCurrentFile(m_zip);
-  if(status != UNZ_OK)
-    return status;
+  unzFile zip = acquire();
+  if(!zip)
+    return UNZ_ERRNO;
 
-  string buffer(BUFFER_SIZE, 0);
+  unz64_file_pos pos{it->second.directoryOffset, it->second.fileNumber};
+  int status = unzGoToFilePos64(zip, &pos);
 
-  const auto readChunk = [&] {
-    return unzReadCurrentFile(m_zip, &buffer[0], (int)buffer.size());
-  };
+  if(status == UNZ_OK)
+    status = unzOpenCurrentFile(zip);
 
-  while(const int len = readChunk()) {
-    if(len < 0)
-      return len; // read error
+  if(status == UNZ_OK) {
+    string buffer(BUFFER_SIZE, 0);
 
-    stream.write(&buffer[0], len);
+    const auto readChunk = [&] {
+      return unzReadCurrentFile(zip, &buffer[0], static_cast<unsigned int>(buffer.size()));
+    };
+
+    while(const int len = readChunk()) {
+      if(len < 0) {
+        status = len; // read error
+        break;
+      }
+
+      stream.write(&buffer[0], len);
+    }
+
+    // also verifies the CRC once the whole file has been read
+    const int closeStatus = unzCloseCurrentFile(zip);
+    if(status == UNZ_OK)
+      status = closeStatus;
   }
 
-  return unzCloseCurrentFile(m_zip);
+  release(zip);
+  return status;
 }
 
 FileExtractor::FileExtractor(const Path &target, const ArchiveReaderPtr &reader)
@@ -243,17 +416,30 @@ bool FileExtractor::run()
     return false;
   }
 
+  // for the registry, not to check the archive (the CRC already did)
+  if(!Hash::fromFile(m_path.temp(), Hash::SHA256, &m_checksum)) {
+    setError({FS::lastError(), m_path.temp().join()});
+    return false;
+  }
+
   return true;
 }
 
-ArchiveWriter::ArchiveWriter(const Path &path)
-{
-  zlib_filefunc64_def filefunc;
-  fill_fopen64_filefunc(&filefunc);
-#ifdef _WIN32
-  filefunc.zopen64_file = wide_fopen;
-#endif
+struct ArchiveWriter::Entry {
+  Path path;
+  int method;
+  uLong crc;
+  uint64_t size;
+  string data;
+  Path spool;
+};
 
+ArchiveWriter::ArchiveWriter(const Path &path,
+    const ArchiveOpts::Compression compression)
+  : m_path(path), m_compression(compression),
+    m_slots(0), m_next(0), m_writing(false)
+{
+  zlib_filefunc64_def filefunc = fileFuncs();
   m_zip = zipOpen2_64(path.join().c_str(), APPEND_STATUS_CREATE, nullptr, &filefunc);
 
   if(!m_zip)
@@ -262,7 +448,79 @@ ArchiveWriter::ArchiveWriter(const Path &path)
 
 ArchiveWriter::~ArchiveWriter()
 {
-  zipClose(m_zip, nullptr);
+  close();
+
+  // entries stuck behind a slot which was never filled (aborted export)
+  for(const auto &[slot, entry] : m_pending) {
+    if(entry && !entry->spool.empty())
+      FS::remove(entry->spool);
+  }
+}
+
+int ArchiveWriter::close()
+{
+  if(!m_zip)
+    return ZIP_OK;
+
+  const int status = zipClose(m_zip, nullptr);
+  m_zip = nullptr;
+  return status;
+}
+
+int ArchiveWriter::compressionLevel() const
+{
+  switch(m_compression) {
+  case ArchiveOpts::FastCompression:
+    return Z_BEST_SPEED;
+  case ArchiveOpts::SmallCompression:
+    return Z_BEST_COMPRESSION;
+  case ArchiveOpts::DefaultCompression:
+    break;
+  }
+
+  return Z_DEFAULT_COMPRESSION;
+}
+
+int ArchiveWriter::compressionMethod(const Path &path,
+  const char *sample, const size_t size) const
+{
+  string extension = path.basename();
+  const size_t dot = extension.rfind('.');
+  extension = dot == string::npos ? string() : extension.substr(dot + 1);
+
+  for(char &c : extension)
+    c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+
+  if(COMPRESSED_EXTS.count(extension))
+    return STORED;
+  else if(m_compression == ArchiveOpts::FastCompression &&
+      POOR_EXTS.count(extension))
+    return STORED;
+
+  // small samples say little about the rest of the file
+  if(size < MIN_SAMPLE_SIZE)
+    return Z_DEFLATED;
+
+  array<size_t, 256> counts{};
+  for(size_t i = 0; i < size; ++i)
+    ++counts[static_cast<unsigned char>(sample[i])];
+
+  double entropy = 0;
+  for(const size_t count : counts) {
+    if(count) {
+      const double p = static_cast<double>(count) / size;
+      entropy -= p * log2(p);
+    }
+  }
+
+  return entropy < MAX_ENTROPY ? Z_DEFLATED : STORED;
+}
+
+Path ArchiveWriter::spoolPath(const size_t slot) const
+{
+  Path path(m_path);
+  path[path.size() - 1] += String::format(".%zu.part", slot);
+  return path;
 }
 
 int ArchiveWriter::addFile(const Path &path)
@@ -279,46 +537,224 @@ int ArchiveWriter::addFile(const Path &path)
 
 int ArchiveWriter::addFile(const Path &path, istream &stream) noexcept
 {
-  const int status = zipOpenNewFileInZip(m_zip, path.join(false).c_str(), nullptr,
-    nullptr, 0, nullptr, 0, nullptr, Z_DEFLATED, Z_DEFAULT_COMPRESSION);
+  return compress(reserve(), path, stream);
+}
+
+size_t ArchiveWriter::reserve()
+{
+  return m_slots++;
+}
+
+void ArchiveWriter::skip(const size_t slot)
+{
+  push(slot, nullptr);
+}
+
+int ArchiveWriter::compress(const size_t slot,
+  const Path &path, istream &stream, Hash *hash) noexcept
+{
+  auto entry = make_unique<Entry>();
+  entry->path = path;
+  entry->crc = crc32(0, nullptr, 0);
+  entry->size = 0;
+
+  string input(BUFFER_SIZE, 0), output(BUFFER_SIZE, 0);
+
+  // the first chunk doubles as the sample used to pick the method
+  stream.read(&input[0], input.size());
+  entry->method = compressionMethod(path, input.data(), stream.gcount());
+
+  // raw deflate stream with the same parameters as minizip's own
+  z_stream zs{};
+  int status = Z_OK;
+
+  if(entry->method == Z_DEFLATED) {
+    status = deflateInit2(&zs, compressionLevel(), Z_DEFLATED,
+      -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+
+    if(status != Z_OK) {
+      skip(slot);
+      return status;
+    }
+  }
+
+  ofstream spool;
+  bool firstChunk = true;
+  int flush;
+
+  do {
+    if(!firstChunk)
+      stream.read(&input[0], input.size());
+    firstChunk = false;
+
+    const uInt len = static_cast<uInt>(stream.gcount());
+
+    if(stream.bad()) {
+      status = Z_ERRNO;
+      break;
+    }
+
+    flush = stream.eof() ? Z_FINISH : Z_NO_FLUSH;
+    entry->crc = crc32(entry->crc, reinterpret_cast<Bytef *>(&input[0]), len);
+    entry->size += len;
+
+    if(hash)
+      hash->addData(&input[0], len);
+
+    if(entry->method == Z_DEFLATED) {
+      zs.next_in = reinterpret_cast<Bytef *>(&input[0]);
+      zs.avail_in = len;
+
+      do {
+        zs.next_out = reinterpret_cast<Bytef *>(&output[0]);
+        zs.avail_out = static_cast<uInt>(output.size());
+        status = deflate(&zs, flush);
+        entry->data.append(output, 0, output.size() - zs.avail_out);
+      } while(zs.avail_out == 0);
+    }
+    else {
+      entry->data.append(input, 0, len);
+      status = flush == Z_FINISH ? Z_STREAM_END : Z_OK;
+    }
+
+    // keep at most SPOOL_THRESHOLD bytes of each pending entry in memory
+    if(entry->data.size() >= SPOOL_THRESHOLD) {
+      if(!spool.is_open()) {
+        entry->spool = spoolPath(slot);
+
+        if(!FS::open(spool, entry->spool)) {
+          status = Z_ERRNO;
+          break;
+        }
+      }
+
+      spool.write(entry->data.data(), entry->data.size());
+      entry->data.clear();
+    }
+  } while(flush != Z_FINISH);
+
+  if(entry->method == Z_DEFLATED)
+    deflateEnd(&zs);
+
+  if(spool.is_open()) {
+    spool.write(entry->data.data(), entry->data.size());
+    entry->data.clear();
+    spool.close();
+
+    if(!spool)
+      status = Z_ERRNO;
+  }
+
+  if(status != Z_STREAM_END) {
+    if(!entry->spool.empty())
+      FS::remove(entry->spool);
+
+    skip(slot);
+    return status == Z_OK ? Z_BUF_ERROR : status;
+  }
+
+  push(slot, move(entry));
+  return ZIP_OK;
+}
+
+void ArchiveWriter::push(const size_t slot, unique_ptr<Entry> entry)
+{
+  unique_lock<mutex> lock(m_mutex);
+  m_pending.emplace(slot, move(entry));
 
-  if(status != ZIP_OK)
-    return status;
+  // another thread is already appending entries and will pick this one up
+  if(m_writing)
+    return;
 
-  string buffer(BUFFER_SIZE, 0);
+  m_writing = true;
 
-  const auto readChunk = [&] {
-    stream.read(&buffer[0], buffer.size());
-    return (int)stream.gcount();
-  };
+  while(!m_pending.empty() && m_pending.begin()->first == m_next) {
+    auto node = m_pending.extract(m_pending.begin());
 
-  while(const int len = readChunk()) {
-    if(len < 0)
-      return len; // write error
+    lock.unlock();
+    if(node.mapped())
+      write(*node.mapped());
+    lock.lock();
 
-    zipWriteInFileInZip(m_zip, &buffer[0], len);
+    ++m_next;
   }
 
-  return zipCloseFileInZip(m_zip);
+  m_writing = false;
+}
+
+void ArchiveWriter::write(const Entry &entry)
+{
+  // the entry is already deflated (or stored): use minizip's raw mode with
+  // the precomputed CRC and uncompressed size
+  int status = zipOpenNewFileInZip2_64(m_zip, entry.path.join(false).c_str(),
+    nullptr, nullptr, 0, nullptr, 0, nullptr, entry.method,
+    entry.method == Z_DEFLATED ? compressionLevel() : Z_NO_COMPRESSION,
+    true, entry.size >= 0xffffffff);
+
+  if(status == ZIP_OK) {
+    if(entry.spool.empty()) {
+      status = zipWriteInFileInZip(m_zip, entry.data.data(),
+        static_cast<unsigned int>(entry.data.size()));
+    }
+    else {
+      ifstream spool;
+
+      if(FS::open(spool, entry.spool)) {
+        string buffer(BUFFER_SIZE, 0);
+
+        while(status == ZIP_OK && spool.read(&buffer[0], buffer.size()).gcount()) {
+          status = zipWriteInFileInZip(m_zip, &buffer[0],
+            static_cast<unsigned int>(spool.gcount()));
+        }
+      }
+      else
+        status = ZIP_ERRNO;
+    }
+
+    const int closeStatus = zipCloseFileInZipRaw64(m_zip, entry.size, entry.crc);
+    if(status == ZIP_OK)
+      status = closeStatus;
+  }
+
+  if(!entry.spool.empty())
+    FS::remove(entry.spool);
+
+  if(status != ZIP_OK) {
+    lock_guard<mutex> guard(m_mutex);
+    m_errors.push_back({String::format("Failed to write file into archive (%d)",
+      status), entry.path.join()});
+  }
 }
 
 FileCompressor::FileCompressor(const Path &target, const ArchiveWriterPtr &writer)
-  : m_path(target), m_writer(writer)
+  : m_path(target), m_writer(writer), m_slot(writer->reserve()),
+    m_unchanged(false)
 {
   setSummary("Compressing %s: " + target.join());
 }
 
 bool FileCompressor::run()
 {
+  Hash::Algorithm algo = Hash::SHA256;
+
+  if(!m_baseChecksum.empty() && Hash::getAlgorithm(m_baseChecksum, &algo) &&
+      Hash::fromFile(m_path, algo, &m_checksum) && m_checksum == m_baseChecksum) {
+    m_writer->skip(m_slot);
+    m_unchanged = true;
+    return true;
+  }
+
   ifstream stream;
   if(!FS::open(stream, m_path)) {
+    m_writer->skip(m_slot);
     setError({
       String::format("Could not open file for export (%s)", FS::lastError()),
       m_path.join()});
     return false;
   }
 
-  const int error = m_writer->addFile(m_path, stream);
+  Hash hash(algo);
+  const int error = m_writer->compress(m_slot, m_path, stream, &hash);
   stream.close();
 
   if(error) {
@@ -326,5 +762,6 @@ bool FileCompressor::run()
     return false;
   }
 
+  m_checksum = hash.digest();
   return true;
 }
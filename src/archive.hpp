@@ -18,17 +18,34 @@
 #ifndef REAPACK_ARCHIVE_HPP
 #define REAPACK_ARCHIVE_HPP
 
+#include "config.hpp"
+#include "errors.hpp"
 #include "path.hpp"
 #include "thread.hpp"
 
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class Hash;
 class ThreadPool;
 
+typedef void *unzFile;
 typedef void *zipFile;
 
 namespace Archive {
   void import(const std::string &path);
 };
 
+// The central directory is indexed once when opening the archive. Each
+// concurrent extraction uses its own handle from a pool of unzFile.
+//
+// Incremental archives only contain the files which changed since their base
+// archive. Missing files are looked up in the chain of base archives.
 class ArchiveReader {
 public:
   ArchiveReader(const Path &path);
@@ -36,21 +53,71 @@ public:
   int extractFile(const Path &);
   int extractFile(const Path &, std::ostream &) noexcept;
 
+  const std::string *checksum(const Path &) const;
+
 private:
-  zipFile m_zip;
+  struct Position {
+    uint64_t directoryOffset;
+    uint64_t fileNumber;
+  };
+
+  ArchiveReader(const Path &path, unsigned int depth);
+  void readManifest(unsigned int depth);
+
+  unzFile open() const;
+  unzFile acquire() noexcept;
+  void release(unzFile) noexcept;
+
+  Path m_path;
+  std::unordered_map<std::string, Position> m_entries;
+  std::unordered_map<std::string, std::string> m_checksums;
+  std::unique_ptr<ArchiveReader> m_base;
+
+  std::mutex m_mutex;
+  std::vector<unzFile> m_handles;
 };
 
 typedef std::shared_ptr<ArchiveReader> ArchiveReaderPtr;
 
+// Entries are deflated by the calling thread (usually a worker) into a
+// memory buffer or a spool file and appended to the zip in the order their
+// slot was reserved, by a single thread at a time. Files which wouldn't
+// shrink much are stored without compression.
 class ArchiveWriter {
 public:
-  ArchiveWriter(const Path &path);
+  ArchiveWriter(const Path &path,
+    ArchiveOpts::Compression = ArchiveOpts::DefaultCompression);
   ~ArchiveWriter();
   int addFile(const Path &fn);
   int addFile(const Path &fn, std::istream &) noexcept;
 
+  size_t reserve();
+  int compress(size_t slot, const Path &fn, std::istream &,
+    Hash * = nullptr) noexcept;
+  void skip(size_t slot);
+
+  int close();
+  const std::vector<ErrorInfo> &errors() const { return m_errors; }
+
 private:
+  struct Entry;
+
+  int compressionLevel() const;
+  int compressionMethod(const Path &, const char *sample, size_t size) const;
+  Path spoolPath(size_t slot) const;
+  void push(size_t slot, std::unique_ptr<Entry>);
+  void write(const Entry &);
+
+  Path m_path;
+  ArchiveOpts::Compression m_compression;
   zipFile m_zip;
+
+  std::mutex m_mutex;
+  std::atomic<size_t> m_slots;
+  size_t m_next;
+  bool m_writing;
+  std::map<size_t, std::unique_ptr<Entry>> m_pending;
+  std::vector<ErrorInfo> m_errors;
 };
 
 typedef std::shared_ptr<ArchiveWriter> ArchiveWriterPtr;
@@ -59,13 +126,15 @@ class FileExtractor : public ThreadTask {
 public:
   FileExtractor(const Path &target, const ArchiveReaderPtr &);
   const TempPath &path() const { return m_path; }
+  const std::string &checksum() const { return m_checksum; }
 
-  bool concurrent() const override { return false; }
+  bool concurrent() const override { return true; }
   bool run() override;
 
 private:
   TempPath m_path;
   ArchiveReaderPtr m_reader;
+  std::string m_checksum;
 };
 
 class FileCompressor : public ThreadTask {
@@ -73,12 +142,21 @@ public:
   FileCompressor(const Path &target, const ArchiveWriterPtr &);
   const Path &path() const { return m_path; }
 
-  bool concurrent() const override { return false; }
+  // skip the file if it still matches this checksum from the base archive
+  void setBaseChecksum(const std::string &checksum) { m_baseChecksum = checksum; }
+  const std::string &checksum() const { return m_checksum; }
+  bool unchanged() const { return m_unchanged; }
+
+  bool concurrent() const override { return true; }
   bool run() override;
 
 private:
   Path m_path;
   ArchiveWriterPtr m_writer;
+  size_t m_slot;
+  std::string m_baseChecksum;
+  std::string m_checksum;
+  bool m_unchanged;
 };
 
 #endif
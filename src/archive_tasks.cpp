@@ -31,19 +31,40 @@
 using namespace std;
 
 static const Path ARCHIVE_TOC("toc");
+static const Path ARCHIVE_MANIFEST("manifest");
 
-ExportTask::ExportTask(const string &path, Transaction *tx)
-  : Task(tx), m_path(path)
+ExportTask::ExportTask(const string &path, const string &basePath,
+    Transaction *tx)
+  : Task(tx), m_path(path), m_basePath(basePath)
 {
 }
 
 bool ExportTask::start()
 {
   stringstream toc;
-  ArchiveWriterPtr writer;
+  ArchiveReaderPtr base;
+
+  if(!m_basePath.empty()) {
+    // the base is referenced by its file name only
+    if(m_basePath.dirname() != m_path.target().dirname()) {
+      tx()->receipt()->addError({"The base archive must be in the same "
+        "directory as the incremental archive", m_basePath.join()});
+      return false;
+    }
+
+    try {
+      base = make_shared<ArchiveReader>(m_basePath);
+    }
+    catch(const reapack_error &e) {
+      tx()->receipt()->addError({string("Could not open base archive: ") +
+        e.what(), m_basePath.join()});
+      return false;
+    }
+  }
 
   try {
-    writer = make_shared<ArchiveWriter>(m_path.temp());
+    m_writer = make_shared<ArchiveWriter>(m_path.temp(),
+      g_reapack->config()->archive.compression);
   }
   catch(const reapack_error &e) {
     tx()->receipt()->addError({string("Could not open archive for writing: ") +
@@ -51,15 +72,28 @@ bool ExportTask::start()
     return false;
   }
 
+  // reserve the first slot of the archive for the table of contents
+  const size_t tocSlot = m_writer->reserve();
   vector<FileCompressor *> jobs;
 
+  const auto addFile = [&](const Path &path) {
+    FileCompressor *job = new FileCompressor(path, m_writer);
+
+    if(base) {
+      if(const string *checksum = base->checksum(path))
+        job->setBaseChecksum(*checksum);
+    }
+
+    jobs.push_back(job);
+  };
+
   for(const Remote &remote : g_reapack->config()->remotes.getEnabled()) {
     bool addedRemote = false;
 
     for(const Registry::Entry &entry : tx()->registry()->getEntries(remote.name())) {
       if(!addedRemote) {
         toc << "REPO " << remote.toString() << '\n';
-        jobs.push_back(new FileCompressor(Index::pathFor(remote.name()), writer));
+        addFile(Index::pathFor(remote.name()));
         addedRemote = true;
       }
 
@@ -71,18 +105,22 @@ bool ExportTask::start()
       ;
 
       for(const Registry::File &file : tx()->registry()->getFiles(entry))
-        jobs.push_back(new FileCompressor(file.path, writer));
+        addFile(file.path);
     }
   }
 
-  writer->addFile(ARCHIVE_TOC, toc);
+  m_writer->compress(tocSlot, ARCHIVE_TOC, toc);
 
-  // Start after we've written the table of contents in the main thread
-  // because we cannot safely write into the zip from more than one
-  // thread at the same time.
+  // Files are compressed concurrently by the workers, the writer then
+  // appends them to the zip in the order they were queued in.
   for(FileCompressor *job : jobs) {
     job->onFinishAsync >> [=] {
-      if(job->state() == ThreadTask::Success)
+      if(job->state() != ThreadTask::Success)
+        return;
+
+      m_checksums[job->path()] = job->checksum();
+
+      if(!job->unchanged())
         tx()->receipt()->addExport(job->path());
     };
 
@@ -94,7 +132,28 @@ bool ExportTask::start()
 
 void ExportTask::commit()
 {
-  if(!FS::rename(m_path)) {
+  // the manifest makes this archive usable as the base of an incremental one
+  stringstream manifest;
+
+  if(!m_basePath.empty())
+    manifest << "BASE " << m_basePath.basename() << '\n';
+
+  for(const auto &[path, checksum] : m_checksums)
+    manifest << checksum << '\t' << path.join(false) << '\n';
+
+  m_writer->compress(m_writer->reserve(), ARCHIVE_MANIFEST, manifest);
+
+  const int status = m_writer->close();
+
+  for(const ErrorInfo &error : m_writer->errors())
+    tx()->receipt()->addError(error);
+
+  if(status) {
+    tx()->receipt()->addError({String::format("Could not finalize archive (%d)",
+      status), m_path.temp().join()});
+    FS::remove(m_path.temp());
+  }
+  else if(!FS::rename(m_path)) {
     tx()->receipt()->addError({string("Could not move to permanent location: ") +
       FS::lastError(), m_path.target().prependRoot().join()});
   }
@@ -102,5 +161,6 @@ void ExportTask::commit()
 
 void ExportTask::rollback()
 {
+  m_writer.reset();
   FS::remove(m_path.temp());
 }
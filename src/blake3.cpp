@@ -0,0 +1,468 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2019  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "blake3.hpp"
+
+#include "cpu.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <system_error>
+#include <thread>
+
+#ifdef REAPACK_CPU_X86
+#  include <immintrin.h>
+#endif
+
+enum Flags {
+  CHUNK_START = 1 << 0,
+  CHUNK_END   = 1 << 1,
+  PARENT      = 1 << 2,
+  ROOT        = 1 << 3,
+};
+
+static constexpr size_t BLOCK_SIZE = 64;
+static constexpr size_t CV_SIZE = 32;
+static constexpr size_t BLOCKS_PER_CHUNK = BLAKE3::CHUNK_SIZE / BLOCK_SIZE;
+
+// subtrees of at most this many chunks are hashed by a single thread
+static constexpr size_t MAX_BATCH = 16;
+// don't bother spawning threads for less than this
+static constexpr size_t MIN_PARALLEL_SIZE = 512 * 1024;
+
+static const uint32_t IV[8] {
+  0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+  0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+// message word order for each of the 7 rounds
+static const uint8_t SCHEDULE[7][16] {
+  {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+  {  2,  6,  3, 10,  7,  0,  4, 13,  1, 11, 12,  5,  9, 14, 15,  8 },
+  {  3,  4, 10, 12, 13,  2,  7, 14,  6,  5,  9,  0, 11, 15,  8,  1 },
+  { 10,  7, 12,  9, 14,  3, 13, 15,  4,  0, 11,  2,  5,  8,  1,  6 },
+  { 12, 13,  9, 11, 15, 10, 14,  8,  7,  2,  5,  3,  0,  1,  6,  4 },
+  {  9, 14, 11,  5,  8, 12, 15,  1, 13,  3,  0, 10,  2,  6,  4,  7 },
+  { 11, 15,  5,  0,  1,  9,  8,  6, 14, 10,  2, 12,  3,  4,  7, 13 },
+};
+
+static inline uint32_t readLE32(const unsigned char *p)
+{
+  return uint32_t(p[0])       | uint32_t(p[1]) << 8 |
+         uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+}
+
+static inline void writeLE32(unsigned char *p, const uint32_t v)
+{
+  p[0] = static_cast<unsigned char>(v);
+  p[1] = static_cast<unsigned char>(v >> 8);
+  p[2] = static_cast<unsigned char>(v >> 16);
+  p[3] = static_cast<unsigned char>(v >> 24);
+}
+
+static inline uint32_t rotr(const uint32_t x, const int n)
+{
+  return (x >> n) | (x << (32 - n));
+}
+
+static inline void g(uint32_t *v, const int a, const int b, const int c,
+  const int d, const uint32_t x, const uint32_t y)
+{
+  v[a] += v[b] + x; v[d] = rotr(v[d] ^ v[a], 16);
+  v[c] += v[d];     v[b] = rotr(v[b] ^ v[c], 12);
+  v[a] += v[b] + y; v[d] = rotr(v[d] ^ v[a], 8);
+  v[c] += v[d];     v[b] = rotr(v[b] ^ v[c], 7);
+}
+
+static void compress(const uint32_t *cv, const unsigned char *block,
+  const uint32_t blockSize, const uint64_t counter, const uint32_t flags,
+  uint32_t *out)
+{
+  uint32_t m[16];
+  for(int i = 0; i < 16; ++i)
+    m[i] = readLE32(block + i * 4);
+
+  uint32_t v[16] {
+    cv[0], cv[1], cv[2], cv[3], cv[4], cv[5], cv[6], cv[7],
+    IV[0], IV[1], IV[2], IV[3],
+    static_cast<uint32_t>(counter), static_cast<uint32_t>(counter >> 32),
+    blockSize, flags,
+  };
+
+  for(const uint8_t *s : SCHEDULE) {
+    g(v, 0, 4,  8, 12, m[s[0]],  m[s[1]]);
+    g(v, 1, 5,  9, 13, m[s[2]],  m[s[3]]);
+    g(v, 2, 6, 10, 14, m[s[4]],  m[s[5]]);
+    g(v, 3, 7, 11, 15, m[s[6]],  m[s[7]]);
+    g(v, 0, 5, 10, 15, m[s[8]],  m[s[9]]);
+    g(v, 1, 6, 11, 12, m[s[10]], m[s[11]]);
+    g(v, 2, 7,  8, 13, m[s[12]], m[s[13]]);
+    g(v, 3, 4,  9, 14, m[s[14]], m[s[15]]);
+  }
+
+  for(int i = 0; i < 8; ++i)
+    out[i] = v[i] ^ v[i + 8];
+}
+
+#ifdef REAPACK_CPU_X86
+CPU_TARGET("avx2")
+static inline __m256i rotr16(const __m256i x)
+{
+  return _mm256_shuffle_epi8(x, _mm256_set_epi8(
+    13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2,
+    13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2));
+}
+
+CPU_TARGET("avx2")
+static inline __m256i rotr8(const __m256i x)
+{
+  return _mm256_shuffle_epi8(x, _mm256_set_epi8(
+    12, 15, 14, 13, 8, 11, 10, 9, 4, 7, 6, 5, 0, 3, 2, 1,
+    12, 15, 14, 13, 8, 11, 10, 9, 4, 7, 6, 5, 0, 3, 2, 1));
+}
+
+CPU_TARGET("avx2")
+static inline __m256i rotr(const __m256i x, const int n)
+{
+  return _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n));
+}
+
+CPU_TARGET("avx2")
+static inline void g(__m256i *v, const int a, const int b, const int c,
+  const int d, const __m256i x, const __m256i y)
+{
+  v[a] = _mm256_add_epi32(_mm256_add_epi32(v[a], v[b]), x);
+  v[d] = rotr16(_mm256_xor_si256(v[d], v[a]));
+  v[c] = _mm256_add_epi32(v[c], v[d]);
+  v[b] = rotr(_mm256_xor_si256(v[b], v[c]), 12);
+  v[a] = _mm256_add_epi32(_mm256_add_epi32(v[a], v[b]), y);
+  v[d] = rotr8(_mm256_xor_si256(v[d], v[a]));
+  v[c] = _mm256_add_epi32(v[c], v[d]);
+  v[b] = rotr(_mm256_xor_si256(v[b], v[c]), 7);
+}
+
+// Hashes 8 inputs of the same number of blocks side by side, one per lane.
+CPU_TARGET("avx2")
+static void hash8AVX2(const unsigned char *const *inputs, const size_t blocks,
+  const uint64_t counter, const bool incrementCounter, const uint32_t flags,
+  const uint32_t flagsStart, const uint32_t flagsEnd, unsigned char *out)
+{
+  __m256i h[8];
+  for(int i = 0; i < 8; ++i)
+    h[i] = _mm256_set1_epi32(static_cast<int>(IV[i]));
+
+  alignas(32) uint32_t counterLow[8], counterHigh[8];
+  for(int lane = 0; lane < 8; ++lane) {
+    const uint64_t laneCounter = counter + (incrementCounter ? lane : 0);
+    counterLow[lane] = static_cast<uint32_t>(laneCounter);
+    counterHigh[lane] = static_cast<uint32_t>(laneCounter >> 32);
+  }
+
+  for(size_t block = 0; block < blocks; ++block) {
+    alignas(32) uint32_t words[16][8];
+    for(int lane = 0; lane < 8; ++lane) {
+      const unsigned char *data = inputs[lane] + block * BLOCK_SIZE;
+      for(int i = 0; i < 16; ++i)
+        words[i][lane] = readLE32(data + i * 4);
+    }
+
+    __m256i m[16];
+    for(int i = 0; i < 16; ++i)
+      m[i] = _mm256_load_si256(reinterpret_cast<const __m256i *>(words[i]));
+
+    uint32_t blockFlags = flags;
+    if(block == 0)
+      blockFlags |= flagsStart;
+    if(block + 1 == blocks)
+      blockFlags |= flagsEnd;
+
+    __m256i v[16] {
+      h[0], h[1], h[2], h[3], h[4], h[5], h[6], h[7],
+      _mm256_set1_epi32(static_cast<int>(IV[0])),
+      _mm256_set1_epi32(static_cast<int>(IV[1])),
+      _mm256_set1_epi32(static_cast<int>(IV[2])),
+      _mm256_set1_epi32(static_cast<int>(IV[3])),
+      _mm256_load_si256(reinterpret_cast<const __m256i *>(counterLow)),
+      _mm256_load_si256(reinterpret_cast<const __m256i *>(counterHigh)),
+      _mm256_set1_epi32(static_cast<int>(BLOCK_SIZE)),
+      _mm256_set1_epi32(static_cast<int>(blockFlags)),
+    };
+
+    for(const uint8_t *s : SCHEDULE) {
+      g(v, 0, 4,  8, 12, m[s[0]],  m[s[1]]);
+      g(v, 1, 5,  9, 13, m[s[2]],  m[s[3]]);
+      g(v, 2, 6, 10, 14, m[s[4]],  m[s[5]]);
+      g(v, 3, 7, 11, 15, m[s[6]],  m[s[7]]);
+      g(v, 0, 5, 10, 15, m[s[8]],  m[s[9]]);
+      g(v, 1, 6, 11, 12, m[s[10]], m[s[11]]);
+      g(v, 2, 7,  8, 13, m[s[12]], m[s[13]]);
+      g(v, 3, 4,  9, 14, m[s[14]], m[s[15]]);
+    }
+
+    for(int i = 0; i < 8; ++i)
+      h[i] = _mm256_xor_si256(v[i], v[i + 8]);
+  }
+
+  alignas(32) uint32_t cvs[8][8];
+  for(int i = 0; i < 8; ++i)
+    _mm256_store_si256(reinterpret_cast<__m256i *>(cvs[i]), h[i]);
+
+  for(int lane = 0; lane < 8; ++lane) {
+    for(int i = 0; i < 8; ++i)
+      writeLE32(out + lane * CV_SIZE + i * 4, cvs[i][lane]);
+  }
+}
+#endif
+
+// Hashes inputs made of full blocks into chaining values using the
+// initial key, as used for whole chunks and for parent nodes.
+static void hashMany(const unsigned char *const *inputs, size_t count,
+  const size_t blocks, uint64_t counter, const bool incrementCounter,
+  const uint32_t flags, const uint32_t flagsStart, const uint32_t flagsEnd,
+  unsigned char *out)
+{
+#ifdef REAPACK_CPU_X86
+  if(count >= 8 && CPU::hasAVX2()) {
+    do {
+      hash8AVX2(inputs, blocks, counter, incrementCounter,
+        flags, flagsStart, flagsEnd, out);
+
+      inputs += 8;
+      count -= 8;
+      out += 8 * CV_SIZE;
+      if(incrementCounter)
+        counter += 8;
+    } while(count >= 8);
+  }
+#endif
+
+  for(; count; --count, ++inputs, out += CV_SIZE) {
+    uint32_t cv[8];
+    std::copy(std::begin(IV), std::end(IV), cv);
+
+    for(size_t block = 0; block < blocks; ++block) {
+      uint32_t blockFlags = flags;
+      if(block == 0)
+        blockFlags |= flagsStart;
+      if(block + 1 == blocks)
+        blockFlags |= flagsEnd;
+
+      compress(cv, *inputs + block * BLOCK_SIZE, BLOCK_SIZE,
+        counter, blockFlags, cv);
+    }
+
+    for(int i = 0; i < 8; ++i)
+      writeLE32(out + i * 4, cv[i]);
+
+    if(incrementCounter)
+      ++counter;
+  }
+}
+
+static void parentCV(const unsigned char *children, unsigned char *out)
+{
+  hashMany(&children, 1, 1, 0, false, PARENT, 0, 0, out);
+}
+
+// Computes the chaining value of a complete subtree of a power of 2 chunks.
+static void subtreeCV(const unsigned char *input, const size_t chunks,
+  const uint64_t counter, unsigned char *out, const unsigned int threads)
+{
+  if(chunks <= MAX_BATCH) {
+    const unsigned char *nodes[MAX_BATCH]{};
+    unsigned char cvs[MAX_BATCH * CV_SIZE];
+
+    for(size_t i = 0; i < chunks; ++i)
+      nodes[i] = input + i * BLAKE3::CHUNK_SIZE;
+
+    hashMany(nodes, chunks, BLOCKS_PER_CHUNK, counter, true,
+      0, CHUNK_START, CHUNK_END, cvs);
+
+    // each pair of adjacent chaining values is the block of their parent
+    for(size_t count = chunks / 2; count; count /= 2) {
+      for(size_t i = 0; i < count; ++i)
+        nodes[i] = cvs + i * BLOCK_SIZE;
+
+      hashMany(nodes, count, 1, 0, false, PARENT, 0, 0, cvs);
+    }
+
+    memcpy(out, cvs, CV_SIZE);
+    return;
+  }
+
+  const size_t half = chunks / 2;
+  const unsigned char *right = input + half * BLAKE3::CHUNK_SIZE;
+  unsigned char children[BLOCK_SIZE];
+
+  if(threads > 1 && chunks * BLAKE3::CHUNK_SIZE >= MIN_PARALLEL_SIZE) {
+    try {
+      std::thread worker(subtreeCV, input, half, counter, children, threads / 2);
+      subtreeCV(right, half, counter + half, children + CV_SIZE,
+        threads - threads / 2);
+      worker.join();
+      parentCV(children, out);
+      return;
+    }
+    catch(const std::system_error &) {
+      // hash both halves in this thread if no more threads can be created
+    }
+  }
+
+  subtreeCV(input, half, counter, children, 1);
+  subtreeCV(right, half, counter + half, children + CV_SIZE, 1);
+  parentCV(children, out);
+}
+
+void BLAKE3::ChunkState::reset(const uint64_t newCounter)
+{
+  std::copy(std::begin(IV), std::end(IV), cv);
+  counter = newCounter;
+  blockSize = 0;
+  blocksCompressed = 0;
+}
+
+uint32_t BLAKE3::ChunkState::flags() const
+{
+  return blocksCompressed ? 0 : CHUNK_START;
+}
+
+void BLAKE3::ChunkState::addData(const unsigned char *data, size_t len)
+{
+  // the last block of the chunk must be kept for finalization
+  while(len) {
+    if(blockSize == sizeof(block)) {
+      compress(cv, block, sizeof(block), counter, flags(), cv);
+      ++blocksCompressed;
+      blockSize = 0;
+    }
+
+    if(!blockSize) {
+      for(; len > sizeof(block); data += sizeof(block), len -= sizeof(block)) {
+        compress(cv, data, sizeof(block), counter, flags(), cv);
+        ++blocksCompressed;
+      }
+    }
+
+    const size_t take = std::min(len, sizeof(block) - blockSize);
+    memcpy(block + blockSize, data, take);
+    blockSize += static_cast<uint8_t>(take);
+    data += take;
+    len -= take;
+  }
+}
+
+BLAKE3::BLAKE3() : m_stackSize(0)
+{
+  m_chunk.reset(0);
+}
+
+void BLAKE3::pushSubtree(const unsigned char *cv, const uint64_t counter,
+  size_t chunks)
+{
+  unsigned char node[BLOCK_SIZE];
+  memcpy(node + CV_SIZE, cv, CV_SIZE);
+
+  // merge every completed subtree, like carrying in a binary addition
+  uint64_t total = counter + chunks;
+  for(; chunks > 1; chunks /= 2)
+    total /= 2;
+
+  for(; !(total & 1); total /= 2) {
+    memcpy(node, m_stack[--m_stackSize], CV_SIZE);
+    parentCV(node, node + CV_SIZE);
+  }
+
+  memcpy(m_stack[m_stackSize++], node + CV_SIZE, CV_SIZE);
+}
+
+void BLAKE3::addData(const char *data, size_t len)
+{
+  const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+
+  while(len) {
+    if(m_chunk.size() == CHUNK_SIZE) {
+      uint32_t cv[8];
+      compress(m_chunk.cv, m_chunk.block, m_chunk.blockSize, m_chunk.counter,
+        m_chunk.flags() | CHUNK_END, cv);
+
+      unsigned char cvBytes[CV_SIZE];
+      for(int i = 0; i < 8; ++i)
+        writeLE32(cvBytes + i * 4, cv[i]);
+
+      pushSubtree(cvBytes, m_chunk.counter, 1);
+      m_chunk.reset(m_chunk.counter + 1);
+    }
+
+    // Hash the largest aligned subtree that leaves some input behind,
+    // as the final chunk and its ancestors must be finalized as the root.
+    if(!m_chunk.size() && len > CHUNK_SIZE) {
+      size_t chunks = 1;
+      while(chunks * 2 * CHUNK_SIZE < len && !(m_chunk.counter & chunks))
+        chunks *= 2;
+
+      const unsigned int threads =
+        chunks * CHUNK_SIZE >= MIN_PARALLEL_SIZE ?
+        std::max(1u, std::thread::hardware_concurrency()) : 1;
+
+      unsigned char cv[CV_SIZE];
+      subtreeCV(bytes, chunks, m_chunk.counter, cv, threads);
+      pushSubtree(cv, m_chunk.counter, chunks);
+      m_chunk.reset(m_chunk.counter + chunks);
+
+      bytes += chunks * CHUNK_SIZE;
+      len -= chunks * CHUNK_SIZE;
+      continue;
+    }
+
+    const size_t take = std::min(len, CHUNK_SIZE - m_chunk.size());
+    m_chunk.addData(bytes, take);
+    bytes += take;
+    len -= take;
+  }
+}
+
+void BLAKE3::getHash(unsigned char *out)
+{
+  // the root node is compressed again with the ROOT flag, so keep its inputs
+  uint32_t cv[8];
+  std::copy(std::begin(m_chunk.cv), std::end(m_chunk.cv), cv);
+  unsigned char block[BLOCK_SIZE] {};
+  memcpy(block, m_chunk.block, m_chunk.blockSize);
+  uint32_t blockSize = m_chunk.blockSize;
+  uint32_t flags = m_chunk.flags() | CHUNK_END;
+  uint64_t counter = m_chunk.counter;
+
+  for(size_t i = m_stackSize; i > 0; --i) {
+    uint32_t childCV[8];
+    compress(cv, block, blockSize, counter, flags, childCV);
+
+    memcpy(block, m_stack[i - 1], CV_SIZE);
+    for(int w = 0; w < 8; ++w)
+      writeLE32(block + CV_SIZE + w * 4, childCV[w]);
+
+    std::copy(std::begin(IV), std::end(IV), cv);
+    blockSize = BLOCK_SIZE;
+    flags = PARENT;
+    counter = 0;
+  }
+
+  uint32_t root[8];
+  compress(cv, block, blockSize, 0, flags | ROOT, root);
+
+  for(int i = 0; i < 8; ++i)
+    writeLE32(out + i * 4, root[i]);
+}
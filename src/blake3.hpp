@@ -0,0 +1,58 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2019  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REAPACK_BLAKE3_HPP
+#define REAPACK_BLAKE3_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// BLAKE3 in its default hashing mode with a 32 byte output.
+// Large inputs are hashed as whole subtrees, using AVX2 to compress 8 chunks
+// at once when available and splitting big subtrees across threads.
+class BLAKE3 {
+public:
+  static constexpr size_t DIGEST_SIZE = 32;
+  static constexpr size_t CHUNK_SIZE = 1024;
+
+  BLAKE3();
+
+  void addData(const char *data, size_t len);
+  void getHash(unsigned char *out);
+
+private:
+  struct ChunkState {
+    uint32_t cv[8];
+    uint64_t counter;
+    unsigned char block[64];
+    uint8_t blockSize;
+    uint8_t blocksCompressed;
+
+    void reset(uint64_t counter);
+    size_t size() const { return blocksCompressed * sizeof(block) + blockSize; }
+    void addData(const unsigned char *data, size_t len);
+    uint32_t flags() const;
+  };
+
+  void pushSubtree(const unsigned char *cv, uint64_t counter, size_t chunks);
+
+  ChunkState m_chunk;
+  unsigned char m_stack[54][32]; // enough for 2^64 bytes of input
+  size_t m_stackSize;
+};
+
+#endif
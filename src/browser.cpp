@@ -26,9 +26,12 @@
 #include "menu.hpp"
 #include "reapack.hpp"
 #include "resource.hpp"
+#include "searchindex.hpp"
 #include "transaction.hpp"
 #include "win32.hpp"
 
+#include <unordered_set>
+
 using namespace std;
 
 enum Timers { TIMER_FILTER = 1, TIMER_ABOUT };
@@ -302,10 +305,22 @@ void Browser::fillSelectionMenu(Menu &menu)
 
 void Browser::updateDisplayLabel()
 {
-  Win32::setWindowText(m_displayBtn, String::format("%s/%s package%s...",
+  // Set the REAPACK_TRACE_FILTER environment variable to show how long the
+  // last filtering took next to the package count.
+  static const bool traceFilter = getenv("REAPACK_TRACE_FILTER") != nullptr;
+
+  string label = String::format("%s/%s package%s...",
     String::number(m_list->visibleRowCount()).c_str(),
     String::number(m_entries.size()).c_str(), m_entries.size() == 1 ? "" : "s"
-  ).c_str());
+  );
+
+  if(traceFilter) {
+    const ListView::FilterStats &stats = m_list->filterStats();
+    label += String::format(" [%s %d rows in %.2f ms]",
+      stats.narrowed ? "narrowed" : "tested", stats.tested, stats.duration);
+  }
+
+  Win32::setWindowText(m_displayBtn, label.c_str());
 }
 
 void Browser::displayButton()
@@ -386,10 +401,54 @@ void Browser::updateFilter()
 {
   stopTimer(TIMER_FILTER);
 
-  m_list->setFilter(Win32::getWindowText(m_filter));
+  applyFilter();
   updateDisplayLabel();
 }
 
+void Browser::applyFilter()
+{
+  const string &filter = Win32::getWindowText(m_filter);
+  const vector<string> &terms = Filter(filter).requiredTerms();
+
+  if(terms.empty()) {
+    m_list->setFilter(filter);
+    return;
+  }
+
+  // Look up the packages of each repository that may contain the words of the
+  // filter in its search index. The others do not need to be tested.
+  auto candidates = make_shared<unordered_set<const Package *>>();
+  auto restricted = make_shared<unordered_set<IndexPtr>>();
+  unordered_set<const Index *> seen;
+
+  for(const Entry &entry : m_entries) {
+    if(!entry.package || !seen.insert(entry.index.get()).second)
+      continue;
+
+    const auto &packages = entry.index->packages();
+    const auto &docs = entry.index->searchIndex().candidates(terms);
+
+    // not worth the lookups if almost every package is a candidate
+    if(docs.size() > packages.size() / 2)
+      continue;
+
+    restricted->insert(entry.index);
+
+    for(const SearchIndex::DocId doc : docs)
+      candidates->insert(packages[doc]);
+  }
+
+  m_list->setFilter(filter, [=](const ListView::Row &row) {
+    const Entry *entry = static_cast<const Entry *>(row.userData);
+
+    // the author of an installed version may not be listed in the index anymore
+    if(!entry->package || !entry->latest || !restricted->count(entry->index))
+      return true;
+
+    return candidates->count(entry->package) > 0;
+  });
+}
+
 void Browser::updateAbout()
 {
   stopTimer(TIMER_ABOUT);
@@ -563,6 +622,8 @@ void Browser::fillList()
   for(const int index : selectIndexes)
     m_list->select(index);
 
+  applyFilter(); // the rows may belong to other packages now
+
   m_list->endEdit(); // filter before calling updateDisplayLabel
   updateDisplayLabel();
 }
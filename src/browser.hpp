@@ -94,6 +94,7 @@ private:
   void transferActions();
   bool match(const Entry &) const;
   void updateFilter();
+  void applyFilter();
   void updateAbout();
   void fillList();
   Entry *getEntry(int listIndex);
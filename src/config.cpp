@@ -17,14 +17,14 @@
 
 #include "config.hpp"
 
-#include "path.hpp"
+#include "filesystem.hpp"
 #include "win32.hpp"
 
-#ifdef _WIN32
-#  include <windows.h>
-#else
-#  include <swell/swell.h>
-#endif
+#include <algorithm>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <fstream>
+#include <sstream>
 
 using namespace std;
 
@@ -47,18 +47,66 @@ static const char *PROXY_KEY = "proxy";
 static const char *VERIFYPEER_KEY = "verifypeer";
 static const char *STALETHRSH_KEY = "stalethreshold";
 
+static const char *ARCHIVE_GRP = "archive";
+static const char *COMPRESSION_KEY = "compression";
+
 static const char *SIZE_KEY = "size";
 
 static const char *REMOTES_GRP = "remotes";
 static const char *REMOTE_KEY  = "remote";
 
+#ifdef _WIN32
+static const char *NEWLINE = "\r\n";
+#else
+static const char *NEWLINE = "\n";
+#endif
+
 inline static string nKey(const char *key, const unsigned int i)
 {
   return key + to_string(i);
 }
 
+static string decodeFile(const string &data)
+{
+#ifdef _WIN32
+  // The Windows profile API stores the file as UTF-16 when it begins with
+  // a byte order mark and uses the ANSI codepage otherwise.
+  if(data.size() >= 2 && data[0] == '\xFF' && data[1] == '\xFE') {
+    const wstring wide(reinterpret_cast<const wchar_t *>(data.data() + 2),
+      (data.size() - 2) / sizeof(wchar_t));
+    return Win32::narrow(wide);
+  }
+
+  return Win32::narrow(Win32::widen(data.c_str(), CP_ACP));
+#else
+  if(data.compare(0, 3, "\xEF\xBB\xBF") == 0)
+    return data.substr(3);
+
+  return data;
+#endif
+}
+
+static void encodeFile(ostream &stream, const string &text)
+{
+#ifdef _WIN32
+  const wstring &wide = Win32::widen(text);
+  stream.write("\xFF\xFE", 2);
+  stream.write(reinterpret_cast<const char *>(wide.data()),
+    wide.size() * sizeof(wchar_t));
+#else
+  stream << text;
+#endif
+}
+
+bool Config::CompareKey::operator()(const string &l, const string &r) const
+{
+  // same as the Windows profile API
+  return boost::algorithm::ilexicographical_compare(l, r);
+}
+
 Config::Config(const Path &path)
-  : m_path(path.join()), m_isFirstRun(false), m_version(0), m_remotesIniSize(0)
+  : m_path(path), m_dirty(false), m_isFirstRun(false), m_version(0),
+    m_remotesIniSize(0)
 {
   resetOptions();
   read();
@@ -73,6 +121,7 @@ void Config::resetOptions()
 {
   install = {false, false, true};
   network = {"", true, NetworkOpts::OneWeekThreshold};
+  archive = {ArchiveOpts::DefaultCompression};
   windowState = {};
 }
 
@@ -142,6 +191,8 @@ void Config::migrate()
 
 void Config::read()
 {
+  load();
+
   install.autoInstall = getBool(INSTALL_GRP, AUTOINSTALL_KEY, install.autoInstall);
   install.bleedingEdge = getBool(INSTALL_GRP, PRERELEASES_KEY, install.bleedingEdge);
   install.promptObsolete = getBool(INSTALL_GRP, PROMPTOBSOLETE_KEY, install.promptObsolete);
@@ -151,6 +202,10 @@ void Config::read()
   network.staleThreshold = (time_t)getUInt(NETWORK_GRP,
     STALETHRSH_KEY, (unsigned int)network.staleThreshold);
 
+  archive.compression = static_cast<ArchiveOpts::Compression>(min(
+    getUInt(ARCHIVE_GRP, COMPRESSION_KEY, archive.compression),
+    static_cast<unsigned int>(ArchiveOpts::SmallCompression)));
+
   windowState.about = getString(ABOUT_GRP, STATE_KEY, windowState.about);
   windowState.browser = getString(BROWSER_GRP, STATE_KEY, windowState.browser);
   windowState.manager = getString(MANAGER_GRP, STATE_KEY, windowState.manager);
@@ -172,12 +227,15 @@ void Config::write()
   setUInt(NETWORK_GRP, VERIFYPEER_KEY, network.verifyPeer);
   setUInt(NETWORK_GRP, STALETHRSH_KEY, (unsigned int)network.staleThreshold);
 
+  setUInt(ARCHIVE_GRP, COMPRESSION_KEY, archive.compression);
+
   setString(ABOUT_GRP, STATE_KEY, windowState.about);
   setString(BROWSER_GRP, STATE_KEY, windowState.browser);
   setString(MANAGER_GRP, STATE_KEY, windowState.manager);
 
-
   writeRemotes();
+
+  flush();
 }
 
 void Config::readRemotes()
@@ -204,20 +262,122 @@ void Config::writeRemotes()
   setUInt(REMOTES_GRP, SIZE_KEY, m_remotesIniSize = i);
 }
 
+void Config::load()
+{
+  m_ini.clear();
+  m_dirty = false;
+
+  ifstream file;
+  if(!FS::open(file, m_path))
+    return; // the file will be created on the next write
+
+  ostringstream contents;
+  contents << file.rdbuf();
+  file.close();
+
+  istringstream stream(decodeFile(contents.str()));
+  IniGroup *group = nullptr;
+  string line;
+
+  while(getline(stream, line)) {
+    boost::algorithm::trim(line);
+
+    if(line.empty() || line[0] == ';')
+      continue;
+    else if(line[0] == '[') {
+      const size_t end = line.find(']');
+      const string &name = line.substr(1, end == string::npos ? end : end - 1);
+      group = &m_ini[name];
+      continue;
+    }
+
+    const size_t equal = line.find('=');
+    if(!group || equal == string::npos)
+      continue;
+
+    string key = line.substr(0, equal), value = line.substr(equal + 1);
+    boost::algorithm::trim(key);
+    boost::algorithm::trim(value);
+
+    if(value.size() >= 2 && (value.front() == '"' || value.front() == '\'')
+        && value.back() == value.front())
+      value = value.substr(1, value.size() - 2);
+
+    group->insert({key, value}); // the first occurrence wins
+  }
+}
+
+void Config::flush()
+{
+  if(!m_dirty)
+    return;
+
+  ostringstream stream;
+
+  for(const auto &[name, group] : m_ini) {
+    if(group.empty())
+      continue;
+
+    if(stream.tellp() > 0)
+      stream << NEWLINE;
+
+    stream << '[' << name << ']' << NEWLINE;
+
+    for(const auto &[key, value] : group)
+      stream << key << '=' << value << NEWLINE;
+  }
+
+  // write the whole file at once to a temporary location and swap it with
+  // the old one to never leave a partially written configuration behind
+  const TempPath path(m_path);
+  ofstream file;
+
+  if(!FS::open(file, path.temp()))
+    return; // retry on the next write
+
+  encodeFile(file, stream.str());
+  file.close();
+
+  if(file.good() && FS::rename(path))
+    m_dirty = false;
+  else
+    FS::remove(path.temp());
+}
+
+const string *Config::findValue(const char *group, const char *key) const
+{
+  const auto &groupIt = m_ini.find(group);
+  if(groupIt == m_ini.end())
+    return nullptr;
+
+  const auto &keyIt = groupIt->second.find(key);
+  if(keyIt == groupIt->second.end())
+    return nullptr;
+
+  return &keyIt->second;
+}
+
 string Config::getString(const char *group, const char *key, const string &fallback) const
 {
-  return Win32::getPrivateProfileString(group, key, fallback.c_str(), m_path.c_str());
+  const string *value = findValue(group, key);
+  return value ? *value : fallback;
 }
 
-void Config::setString(const char *group, const char *key, const string &val) const
+void Config::setString(const char *group, const char *key, const string &val)
 {
-  Win32::writePrivateProfileString(group, key, val.c_str(), m_path.c_str());
+  const auto &[it, inserted] = m_ini[group].try_emplace(key, val);
+
+  if(inserted || it->second != val) {
+    it->second = val;
+    m_dirty = true;
+  }
 }
 
 unsigned int Config::getUInt(const char *group,
   const char *key, const unsigned int fallback) const
 {
-  return Win32::getPrivateProfileInt(group, key, fallback, m_path.c_str());
+  const string *value = findValue(group, key);
+  return value ? static_cast<unsigned int>(strtoul(value->c_str(), nullptr, 10)) : fallback;
 }
 
 bool Config::getBool(const char *group, const char *key, const bool fallback) const
@@ -225,18 +385,21 @@ bool Config::getBool(const char *group, const char *key, const bool fallback) co
   return getUInt(group, key, fallback) > 0;
 }
 
-void Config::setUInt(const char *group, const char *key, const unsigned int val) const
+void Config::setUInt(const char *group, const char *key, const unsigned int val)
 {
   setString(group, key, to_string(val));
 }
 
-void Config::deleteKey(const char *group, const char *key) const
+void Config::deleteKey(const char *group, const char *key)
 {
-  Win32::writePrivateProfileString(group, key, nullptr, m_path.c_str());
+  const auto &groupIt = m_ini.find(group);
+
+  if(groupIt != m_ini.end() && groupIt->second.erase(key))
+    m_dirty = true;
 }
 
 void Config::cleanupArray(const char *group, const char *key,
-  const unsigned int begin, const unsigned int end) const
+  const unsigned int begin, const unsigned int end)
 {
   for(unsigned int i = begin; i < end; i++)
     deleteKey(group, nKey(key, i).c_str());
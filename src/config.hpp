@@ -18,12 +18,12 @@
 #ifndef REAPACK_CONFIG_HPP
 #define REAPACK_CONFIG_HPP
 
+#include "path.hpp"
 #include "remote.hpp"
 
+#include <map>
 #include <string>
 
-class Path;
-
 struct WindowState {
   std::string about;
   std::string browser;
@@ -47,6 +47,16 @@ struct NetworkOpts {
   time_t staleThreshold;
 };
 
+struct ArchiveOpts {
+  enum Compression {
+    FastCompression,
+    DefaultCompression,
+    SmallCompression,
+  };
+
+  Compression compression;
+};
+
 class Config {
 public:
   Config(const Path &);
@@ -63,24 +73,39 @@ public:
 
   InstallOpts install;
   NetworkOpts network;
+  ArchiveOpts archive;
   WindowState windowState;
 
   RemoteList remotes;
 
 private:
+  class CompareKey {
+  public:
+    bool operator()(const std::string &, const std::string &) const;
+  };
+
+  typedef std::map<std::string, std::string, CompareKey> IniGroup;
+  typedef std::map<std::string, IniGroup, CompareKey> IniFile;
+
+  void load();
+  void flush();
+
+  const std::string *findValue(const char *g, const char *k) const;
   std::string getString(const char *g, const char *k, const std::string &fallback = {}) const;
-  void setString(const char *g, const char *k, const std::string &v) const;
+  void setString(const char *g, const char *k, const std::string &v);
 
   bool getBool(const char *g, const char *k, bool fallback = false) const;
   unsigned int getUInt(const char *g, const char *k, unsigned int fallback = 0) const;
-  void setUInt(const char *g, const char *k, unsigned int v) const;
+  void setUInt(const char *g, const char *k, unsigned int v);
 
-  void deleteKey(const char *g, const char *k) const;
-  void cleanupArray(const char *g, const char *k, unsigned int begin, unsigned int end) const;
+  void deleteKey(const char *g, const char *k);
+  void cleanupArray(const char *g, const char *k, unsigned int begin, unsigned int end);
 
   void migrate();
 
-  std::string m_path;
+  Path m_path;
+  IniFile m_ini;
+  bool m_dirty;
   bool m_isFirstRun;
   unsigned int m_version;
 
@@ -0,0 +1,103 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2019  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cpu.hpp"
+
+#ifdef REAPACK_CPU_X86
+#  include <algorithm>
+#  include <cstdint>
+
+#  ifdef _MSC_VER
+#    include <intrin.h>
+#  else
+#    include <cpuid.h>
+#  endif
+
+struct Features {
+  bool shani;
+  bool avx2;
+
+  Features() : shani(false), avx2(false)
+  {
+    unsigned int leaf1[4]{}, leaf7[4]{};
+#  ifdef _MSC_VER
+    int regs[4];
+    __cpuid(regs, 0);
+    const unsigned int maxLeaf = regs[0];
+    __cpuid(regs, 1);
+    std::copy(regs, regs + 4, leaf1);
+    if(maxLeaf >= 7) {
+      __cpuidex(regs, 7, 0);
+      std::copy(regs, regs + 4, leaf7);
+    }
+#  else
+    if(!__get_cpuid(1, &leaf1[0], &leaf1[1], &leaf1[2], &leaf1[3]))
+      return;
+    __get_cpuid_count(7, 0, &leaf7[0], &leaf7[1], &leaf7[2], &leaf7[3]);
+#  endif
+
+    const bool ssse3 = leaf1[2] & (1 << 9), sse41 = leaf1[2] & (1 << 19);
+    shani = ssse3 && sse41 && (leaf7[1] & (1 << 29));
+
+    // AVX2 also requires the OS to save the YMM registers
+    const bool osxsave = leaf1[2] & (1 << 27);
+    if(osxsave && (leaf7[1] & (1 << 5)))
+      avx2 = (xgetbv() & 6) == 6;
+  }
+
+private:
+  static uint64_t xgetbv()
+  {
+#  ifdef _MSC_VER
+    return _xgetbv(0);
+#  else
+    uint32_t eax, edx;
+    __asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return uint64_t(edx) << 32 | eax;
+#  endif
+  }
+};
+
+static const Features &features()
+{
+  static const Features features;
+  return features;
+}
+
+bool CPU::hasSHA()
+{
+  return features().shani;
+}
+
+bool CPU::hasAVX2()
+{
+  return features().avx2;
+}
+
+#else
+
+bool CPU::hasSHA()
+{
+  return false;
+}
+
+bool CPU::hasAVX2()
+{
+  return false;
+}
+
+#endif
@@ -0,0 +1,38 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2019  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REAPACK_CPU_HPP
+#define REAPACK_CPU_HPP
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#  define REAPACK_CPU_X86
+#endif
+
+// Enables instruction set extensions for a single function so that
+// accelerated code paths can be selected at runtime.
+#if defined(_MSC_VER) && !defined(__clang__)
+#  define CPU_TARGET(features)
+#else
+#  define CPU_TARGET(features) __attribute__((target(features)))
+#endif
+
+namespace CPU {
+  bool hasSHA(); // SHA extensions, SSSE3 and SSE4.1
+  bool hasAVX2();
+};
+
+#endif
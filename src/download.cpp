@@ -22,6 +22,7 @@
 #include "reapack.hpp"
 
 #include <cassert>
+#include <mutex>
 
 #include <reaper_plugin_functions.h>
 
@@ -33,6 +34,7 @@ static const int DOWNLOAD_TIMEOUT = 15;
 
 static CURLSH *g_curlShare = nullptr;
 static mutex g_curlMutex;
+static once_flag g_curlInit;
 
 static void LockCurlMutex(CURL *, curl_lock_data, curl_lock_access, void *)
 {
@@ -60,12 +62,18 @@ void DownloadContext::GlobalInit()
 
 void DownloadContext::GlobalCleanup()
 {
+  // curl is initialized on the first download, not when REAPER starts
+  if(!g_curlShare)
+    return;
+
   curl_share_cleanup(g_curlShare);
   curl_global_cleanup();
 }
 
 DownloadContext::DownloadContext()
 {
+  call_once(g_curlInit, &DownloadContext::GlobalInit);
+
   m_curl = curl_easy_init();
 
   char userAgent[64];
@@ -118,11 +126,10 @@ bool Download::run()
 {
   WriteContext write;
 
-  Hash::Algorithm algo;
+  // downloads without an expected checksum are still hashed for the registry
+  Hash::Algorithm algo = Hash::SHA256;
   if(!m_expectedChecksum.empty()) {
-    if(Hash::getAlgorithm(m_expectedChecksum, &algo))
-      write.hash = make_unique<Hash>(algo);
-    else {
+    if(!Hash::getAlgorithm(m_expectedChecksum, &algo)) {
       const string &error = String::format(
         "Unsupported checksum: %s", m_expectedChecksum.c_str());
       setError({error, m_url});
@@ -130,6 +137,8 @@ bool Download::run()
     }
   }
 
+  write.hash = make_unique<Hash>(algo);
+
   if(!(write.stream = openStream()))
     return false;
 
@@ -166,7 +175,8 @@ bool Download::run()
     setError({err, m_url});
     return false;
   }
-  else if(write.hash && write.hash->digest() != m_expectedChecksum) {
+  else if(!m_expectedChecksum.empty() &&
+      write.hash->digest() != m_expectedChecksum) {
     const string &err = String::format(
       "Checksum mismatch.\nExpected: %s\nActual: %s",
       m_expectedChecksum.c_str(), write.hash->digest().c_str()
@@ -175,6 +185,7 @@ bool Download::run()
     return false;
   }
 
+  m_checksum = write.hash->digest();
   return true;
 }
 
@@ -194,14 +205,36 @@ MemoryDownload::MemoryDownload(const string &url, const NetworkOpts &opts, int f
 
 FileDownload::FileDownload(const Path &target, const string &url,
     const NetworkOpts &opts, int flags)
-  : Download(url, opts, flags), m_path(target)
+  : Download(url, opts, flags), m_path(target), m_reuseTemp(false),
+    m_unchanged(false)
 {
   setName(target.join());
 }
 
+bool FileDownload::run()
+{
+  // the installed file may already be identical (eg. when reinstalling)
+  if(!expectedChecksum().empty() &&
+      Hash::verify(m_path.target(), expectedChecksum())) {
+    m_unchanged = true;
+    setChecksum(expectedChecksum());
+    return true;
+  }
+
+  // the file may have been fully downloaded by an interrupted transaction
+  if(m_reuseTemp && Hash::verify(m_path.temp(), expectedChecksum())) {
+    setChecksum(expectedChecksum());
+    return true;
+  }
+
+  return Download::run();
+}
+
 bool FileDownload::save()
 {
-  if(state() == Success)
+  if(m_unchanged)
+    return true;
+  else if(state() == Success)
     return FS::rename(m_path);
   else
     return FS::remove(m_path.temp());
@@ -31,7 +31,6 @@ class Hash;
 
 class DownloadContext {
 public:
-  static void GlobalInit();
   static void GlobalCleanup();
 
   DownloadContext();
@@ -40,6 +39,8 @@ public:
   operator CURL*() { return m_curl; }
 
 private:
+  static void GlobalInit();
+
   CURL *m_curl;
 };
 
@@ -55,6 +56,9 @@ public:
   void setExpectedChecksum(const std::string &checksum) {
     m_expectedChecksum = checksum;
   }
+  const std::string &expectedChecksum() const { return m_expectedChecksum; }
+  // checksum of the downloaded data, available after a successful run
+  const std::string &checksum() const { return m_checksum; }
   const std::string &url() const { return m_url; }
 
   bool concurrent() const override { return true; }
@@ -63,6 +67,7 @@ public:
 protected:
   virtual std::ostream *openStream() = 0;
   virtual void closeStream() {}
+  void setChecksum(const std::string &checksum) { m_checksum = checksum; }
 
 private:
   struct WriteContext {
@@ -79,6 +84,7 @@ private:
 
   std::string m_url;
   std::string m_expectedChecksum;
+  std::string m_checksum;
   NetworkOpts m_opts;
   int m_flags;
 };
@@ -102,14 +108,21 @@ public:
     const NetworkOpts &, int flags = 0);
 
   const TempPath &path() const { return m_path; }
+  void setReuseTemp(bool reuse) { m_reuseTemp = reuse; }
+  // whether the target already matched the expected checksum (nothing to save)
+  bool unchanged() const { return m_unchanged; }
   bool save();
 
+  bool run() override;
+
 protected:
   std::ostream *openStream() override;
   void closeStream() override;
 
 private:
   TempPath m_path;
+  bool m_reuseTemp;
+  bool m_unchanged;
   std::ofstream m_stream;
 };
 
@@ -17,11 +17,44 @@
 
 #include "event.hpp"
 
+#include <algorithm>
+
 #include <reaper_plugin_functions.h>
 
+struct AsyncEventImpl::Node {
+  Node *next;
+  const void *source;
+  MainThreadFunc func; // empty for the markers queued by Loop::forget
+};
+
+// Each thread takes nodes from the recycled list all at once and keeps them
+// for itself, so they are never popped concurrently (no ABA problem).
+static thread_local struct NodeCache {
+  ~NodeCache()
+  {
+    while(head) {
+      AsyncEventImpl::Node *node = head;
+      head = node->next;
+      delete node;
+    }
+  }
+
+  AsyncEventImpl::Node *head = nullptr;
+} s_nodeCache;
+
 static std::weak_ptr<AsyncEventImpl::Loop> s_loop;
 
+static void deleteNodes(AsyncEventImpl::Node *node)
+{
+  while(node) {
+    AsyncEventImpl::Node *next = node->next;
+    delete node;
+    node = next;
+  }
+}
+
 AsyncEventImpl::Loop::Loop()
+  : m_queue(nullptr), m_free(nullptr), m_pending(nullptr)
 {
   plugin_register("timer", reinterpret_cast<void *>(&mainThreadTimer));
 }
@@ -29,6 +62,10 @@ AsyncEventImpl::Loop::Loop()
 AsyncEventImpl::Loop::~Loop()
 {
   plugin_register("-timer", reinterpret_cast<void *>(&mainThreadTimer));
+
+  deleteNodes(m_queue.load());
+  deleteNodes(m_free.load());
+  deleteNodes(m_pending);
 }
 
 void AsyncEventImpl::Loop::mainThreadTimer()
@@ -36,29 +73,103 @@ void AsyncEventImpl::Loop::mainThreadTimer()
   s_loop.lock()->processQueue();
 }
 
-void AsyncEventImpl::Loop::push(const MainThreadFunc &event, const void *source)
+auto AsyncEventImpl::Loop::allocate() -> Node *
+{
+  Node *&cache = s_nodeCache.head;
+
+  if(!cache)
+    cache = m_free.exchange(nullptr, std::memory_order_acquire);
+
+  if(!cache)
+    return new Node;
+
+  Node *node = cache;
+  cache = node->next;
+  return node;
+}
+
+void AsyncEventImpl::Loop::enqueue(Node *node)
 {
-  std::lock_guard<std::mutex> guard(m_mutex);
-  m_queue.insert({source, event});
+  node->next = m_queue.load(std::memory_order_relaxed);
+  while(!m_queue.compare_exchange_weak(node->next, node,
+    std::memory_order_release, std::memory_order_relaxed));
+}
+
+void AsyncEventImpl::Loop::recycle(Node *node)
+{
+  node->func = nullptr;
+
+  node->next = m_free.load(std::memory_order_relaxed);
+  while(!m_free.compare_exchange_weak(node->next, node,
+    std::memory_order_release, std::memory_order_relaxed));
+}
+
+void AsyncEventImpl::Loop::push(MainThreadFunc &&event, const void *source)
+{
+  Node *node = allocate();
+  node->source = source;
+  node->func = std::move(event);
+  enqueue(node);
 }
 
 void AsyncEventImpl::Loop::forget(const void *source)
 {
-  std::lock_guard<std::mutex> guard(m_mutex);
-  m_queue.erase(source);
+  // discard the events of the batch being processed (when deleted by a handler)
+  for(Node *node = m_pending; node; node = node->next) {
+    if(node->source == source) {
+      node->source = nullptr;
+      node->func = nullptr;
+    }
+  }
+
+  // and let processQueue discard the ones queued before this marker
+  Node *marker = allocate();
+  marker->source = source;
+  marker->func = nullptr;
+  enqueue(marker);
 }
 
 void AsyncEventImpl::Loop::processQueue()
 {
-  decltype(m_queue) events;
+  if(!m_queue.load(std::memory_order_relaxed))
+    return;
 
-  {
-    std::lock_guard<std::mutex> guard(m_mutex);
-    std::swap(events, m_queue);
+  Node *batch = m_queue.exchange(nullptr, std::memory_order_acquire);
+
+  // restore the emission order while skipping events whose emitter was
+  // forgotten after posting them (markers are reached first in this order)
+  Node *ordered = nullptr;
+
+  while(batch) {
+    Node *node = batch;
+    batch = node->next;
+
+    if(!node->func) {
+      if(node->source)
+        m_forgotten.push_back(node->source);
+      recycle(node);
+    }
+    else if(std::find(m_forgotten.begin(), m_forgotten.end(),
+        node->source) != m_forgotten.end())
+      recycle(node);
+    else {
+      node->next = ordered;
+      ordered = node;
+    }
   }
 
-  for(const auto &[emitter, func] : events)
-    func();
+  m_forgotten.clear();
+  m_pending = ordered;
+
+  while(m_pending) {
+    Node *node = m_pending;
+    m_pending = node->next;
+
+    if(node->func)
+      node->func();
+
+    recycle(node);
+  }
 }
 
 AsyncEventImpl::Emitter::Emitter()
@@ -75,7 +186,7 @@ AsyncEventImpl::Emitter::~Emitter()
     m_loop->forget(this);
 }
 
-void AsyncEventImpl::Emitter::runInMainThread(const MainThreadFunc &event) const
+void AsyncEventImpl::Emitter::runInMainThread(MainThreadFunc &&event) const
 {
-  m_loop->push(event, this);
+  m_loop->push(std::move(event), this);
 }
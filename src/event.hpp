@@ -18,11 +18,10 @@
 #ifndef REAPACK_EVENT_HPP
 #define REAPACK_EVENT_HPP
 
+#include <atomic>
 #include <functional>
 #include <future>
-#include <map>
 #include <memory>
-#include <mutex>
 #include <optional>
 #include <vector>
 
@@ -69,20 +68,30 @@ private:
 namespace AsyncEventImpl {
   typedef std::function<void ()> MainThreadFunc;
 
+  struct Node;
+
   class Loop {
   public:
     Loop();
     ~Loop();
 
-    void push(const MainThreadFunc &, const void *source = nullptr);
+    void push(MainThreadFunc &&, const void *source = nullptr);
     void forget(const void *source);
 
   private:
     static void mainThreadTimer();
     void processQueue();
+    void enqueue(Node *);
+    void recycle(Node *);
+    Node *allocate();
+
+    // lock-free stacks of nodes, newest first
+    std::atomic<Node *> m_queue;
+    std::atomic<Node *> m_free;
 
-    std::mutex m_mutex;
-    std::multimap<const void *, MainThreadFunc> m_queue;
+    // main thread only
+    Node *m_pending;
+    std::vector<const void *> m_forgotten;
   };
 
   class Emitter {
@@ -90,7 +99,7 @@ namespace AsyncEventImpl {
     Emitter();
     ~Emitter();
 
-    void runInMainThread(const MainThreadFunc &) const;
+    void runInMainThread(MainThreadFunc &&) const;
 
   private:
     std::shared_ptr<Loop> m_loop;
@@ -105,7 +114,14 @@ class AsyncEvent<R(Args...)> : public Event<R(Args...)> {
 public:
   using typename Event<R(Args...)>::ReturnType;
 
-  std::future<ReturnType> operator()(Args... args) const
+  void operator()(Args... args) const
+  {
+    if(*this)
+      m_emitter.runInMainThread([=] { Event<R(Args...)>::operator()(args...); });
+  }
+
+  // same as operator() but the return value of the handlers can be waited for
+  std::future<ReturnType> future(Args... args) const
   {
     auto promise = std::make_shared<std::promise<ReturnType>>();
 
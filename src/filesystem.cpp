@@ -28,6 +28,9 @@
 #ifdef _WIN32
 #  include <windows.h>
 #  define stat _stat
+#else
+#  include <dirent.h>
+#  include <fcntl.h>
 #endif
 
 using namespace std;
@@ -165,6 +168,19 @@ bool FS::mtime(const Path &path, time_t *time)
   return true;
 }
 
+bool FS::getInfo(const Path &path, FileInfo *info)
+{
+  struct stat st;
+
+  if(!stat(path, &st))
+    return false;
+
+  info->mtime = st.st_mtime;
+  info->size = st.st_size;
+
+  return true;
+}
+
 bool FS::exists(const Path &path, const bool dir)
 {
   struct stat st;
@@ -182,8 +198,8 @@ bool FS::mkdir(const Path &path)
 
   Path fullPath = Path::root();
 
-  for(const string &dir : path) {
-    fullPath.append(dir);
+  for(const string_view &dir : path) {
+    fullPath.append(string(dir));
 
     const auto &joined = Win32::widen(fullPath.join());
 
@@ -199,6 +215,68 @@ bool FS::mkdir(const Path &path)
   return true;
 }
 
+bool FS::DirCache::exists(const Path &path)
+{
+  if(list(path.dirname()).count(path.basename()))
+    return true;
+
+  // the name may differ in case only on case-insensitive filesystems
+  return FS::exists(path);
+}
+
+auto FS::DirCache::list(const Path &dir) -> const Listing &
+{
+  const auto &[it, isNew] = m_dirs.try_emplace(dir);
+  Listing &files = it->second;
+
+  if(!isNew)
+    return files;
+
+#ifdef _WIN32
+  const auto &pattern = nativePath(dir + "*");
+
+  WIN32_FIND_DATA fd;
+  const HANDLE handle = FindFirstFileEx(pattern.c_str(),
+    FindExInfoBasic, &fd, FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+
+  if(handle == INVALID_HANDLE_VALUE)
+    return files;
+
+  do {
+    if(!(fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+      files.insert(Win32::narrow(fd.cFileName));
+  } while(FindNextFile(handle, &fd));
+
+  FindClose(handle);
+#else
+  DIR *handle = opendir(nativePath(dir).c_str());
+
+  if(!handle)
+    return files;
+
+  while(const dirent *entry = readdir(handle)) {
+    switch(entry->d_type) {
+    case DT_DIR:
+      continue;
+    case DT_LNK:
+    case DT_UNKNOWN: {
+      // the filesystem or a symbolic link hides the type of the file
+      struct stat st;
+      if(fstatat(dirfd(handle), entry->d_name, &st, 0) || S_ISDIR(st.st_mode))
+        continue;
+      break;
+    }
+    }
+
+    files.insert(entry->d_name);
+  }
+
+  closedir(handle);
+#endif
+
+  return files;
+}
+
 const char *FS::lastError()
 {
   return strerror(errno);
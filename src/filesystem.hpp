@@ -18,13 +18,27 @@
 #ifndef REAPACK_FILESYSTEM_HPP
 #define REAPACK_FILESYSTEM_HPP
 
+#include "path.hpp"
+
 #include <algorithm>
+#include <cstdint>
+#include <ctime>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 
-class Path;
 class TempPath;
 
 namespace FS {
+  struct FileInfo {
+    time_t mtime;
+    uint64_t size;
+
+    bool operator==(const FileInfo &o) const
+      { return mtime == o.mtime && size == o.size; }
+    bool operator!=(const FileInfo &o) const { return !(*this == o); }
+  };
+
   FILE *open(const Path &);
   bool open(std::ifstream &, const Path &);
   bool open(std::ofstream &, const Path &);
@@ -34,11 +48,26 @@ namespace FS {
   bool remove(const Path &);
   bool removeRecursive(const Path &);
   bool mtime(const Path &, time_t *);
+  bool getInfo(const Path &, FileInfo *);
   bool exists(const Path &, bool dir = false);
   bool mkdir(const Path &);
 
   const char *lastError();
 
+  // Answers many lookups with a single listing of each directory instead of
+  // one stat per file. Not thread-safe: use one instance per thread.
+  class DirCache {
+  public:
+    bool exists(const Path &);
+
+  private:
+    typedef std::unordered_set<std::string> Listing;
+
+    const Listing &list(const Path &dir);
+
+    std::unordered_map<Path, Listing> m_dirs;
+  };
+
   template<typename T, typename =
     std::enable_if_t<std::is_convertible<typename T::value_type, Path>::value>>
   bool allExists(const T &container, const bool dir = false)
@@ -17,7 +17,69 @@
 
 #include "filter.hpp"
 
-#include <boost/algorithm/string/case_conv.hpp>
+#include "cpu.hpp"
+#include "string.hpp"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define FILTER_SSE2
+#  include <emmintrin.h>
+#  ifdef _MSC_VER
+#    include <intrin.h>
+#  endif
+#endif
+
+static size_t find(const std::string &haystack, const std::string &needle,
+  size_t from)
+{
+#ifdef FILTER_SSE2
+  // Compare the first and last characters of the needle at 16 positions at
+  // once, then check the rest only where both are found.
+  // See http://0x80.pl/articles/simd-strfind.html
+  const size_t size = needle.size();
+  const char *data = haystack.data();
+  const __m128i first = _mm_set1_epi8(needle.front()),
+                last  = _mm_set1_epi8(needle.back());
+
+  for(; from + size + 15 <= haystack.size(); from += 16) {
+    const __m128i blockFirst = _mm_loadu_si128(
+      reinterpret_cast<const __m128i *>(data + from));
+    const __m128i blockLast = _mm_loadu_si128(
+      reinterpret_cast<const __m128i *>(data + from + size - 1));
+
+    unsigned int mask = _mm_movemask_epi8(_mm_and_si128(
+      _mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last)));
+
+    while(mask) {
+#ifdef _MSC_VER
+      unsigned long bit;
+      _BitScanForward(&bit, mask);
+#else
+      const int bit = __builtin_ctz(mask);
+#endif
+
+      if(!memcmp(data + from + bit + 1, needle.data() + 1, size - 1))
+        return from + bit;
+
+      mask &= mask - 1;
+    }
+  }
+#endif
+
+  return haystack.find(needle, from);
+}
+
+Filter::Text::Text(const std::vector<std::string> &values)
+  : m_count(values.size())
+{
+  for(const std::string &value : values) {
+    if(!m_buffer.empty())
+      m_buffer += '\0';
+
+    m_buffer += String::fold(value);
+  }
+}
 
 Filter::Filter(const std::string &input)
   : m_root(Group::MatchAll)
@@ -62,14 +124,73 @@ void Filter::set(const std::string &input)
   }
 
   group->push(buf, &flags);
+
+  m_program.clear();
+  m_root.compile(&m_program);
 }
 
-bool Filter::match(std::vector<std::string> rows) const
+bool Filter::match(const Text &text) const
 {
-  for(std::string &str : rows)
-    boost::algorithm::to_lower(str);
+  return match(0, text);
+}
+
+bool Filter::match(const size_t index, const Text &text) const
+{
+  const Op &op = m_program[index];
+  const bool isNot = (op.flags & Node::NotFlag) != 0;
+
+  switch(op.type) {
+  case Op::Token:
+    return matchToken(op, text);
+  case Op::MatchAll:
+    for(size_t child = index + 1; child < op.end; child = m_program[child].end) {
+      if(!match(child, text))
+        return isNot;
+    }
+
+    return !isNot;
+  case Op::MatchAny:
+    for(size_t child = index + 1; child < op.end; child = m_program[child].end) {
+      if(match(child, text))
+        return true;
+    }
+
+    return false;
+  }
+
+  return false; // to make MSVC happy
+}
+
+bool Filter::matchToken(const Op &op, const Text &text) const
+{
+  const std::string &str = text.m_buffer, &needle = op.needle;
+  const auto test = [&op](const Node::Flag f) { return (op.flags & f) != 0; };
+
+  bool found = false;
+
+  for(size_t pos = 0; !found && (pos = find(str, needle, pos)) != std::string::npos; ++pos) {
+    const size_t after = pos + needle.size();
+    const bool isStart = pos == 0 || str[pos - 1] == '\0',
+               isEnd   = after == str.size() || str[after] == '\0';
+
+    if(test(Node::StartAnchorFlag) && !isStart)
+      continue;
+    if(test(Node::EndAnchorFlag) && !isEnd)
+      continue;
+    if(test(Node::QuotedFlag) && !test(Node::PhraseFlag)) {
+      found =
+        (isStart || !isalnum(static_cast<unsigned char>(str[pos - 1]))) &&
+        (isEnd || !isalnum(static_cast<unsigned char>(str[after])));
+    }
+    else
+      found = true;
+  }
 
-  return m_root.match(rows);
+  // NOT matches when none of the values (and there must be some) do
+  if(test(Node::NotFlag))
+    return text.m_count > 0 && !found;
+
+  return found;
 }
 
 Filter::Group::Group(Type type, int flags, Group *parent)
@@ -145,59 +266,100 @@ Filter::Group *Filter::Group::addSubGroup(const Type type, const int flags)
   return ptr;
 }
 
-bool Filter::Group::match(const std::vector<std::string> &rows) const
+std::vector<std::string> Filter::requiredTerms() const
 {
-  for(const auto &node : m_nodes) {
-    if(node->match(rows)) {
-      if(m_type == MatchAny)
-        return true;
-    }
-    else if(m_type == MatchAll)
-      return test(NotFlag);
+  std::vector<std::string> terms;
+
+  const Op &root = m_program[0];
+  for(size_t i = 1; i < root.end; i = m_program[i].end) {
+    const Op &op = m_program[i];
+    if(op.type == Op::Token && !(op.flags & Node::NotFlag))
+      terms.push_back(op.needle);
   }
 
-  return m_type == MatchAll && !test(NotFlag);
+  return terms;
 }
 
-Filter::Token::Token(const std::string &buf, int flags)
-  : Node(flags), m_buf(buf)
+bool Filter::implies(const Filter &other) const
 {
-  boost::algorithm::to_lower(m_buf);
-}
+  // only compare the terms of the outermost AND group (the root) one by one:
+  // each term of the other filter must be implied by one of ours
+  const Op &root = m_program[0], &otherRoot = other.m_program[0];
 
-bool Filter::Token::match(const std::vector<std::string> &rows) const
-{
-  const bool isNot = test(NotFlag);
-  bool match = false;
+  for(size_t theirs = 1; theirs < otherRoot.end; theirs = other.m_program[theirs].end) {
+    bool implied = false;
+
+    for(size_t ours = 1; !implied && ours < root.end; ours = m_program[ours].end)
+      implied = implies(ours, other, theirs);
 
-  for(const std::string &row : rows) {
-    if(matchRow(row) ^ isNot)
-      match = true;
-    else if(isNot)
+    if(!implied)
       return false;
   }
 
-  return match;
+  return true;
 }
 
-bool Filter::Token::matchRow(const std::string &str) const
+bool Filter::implies(const size_t index, const Filter &other,
+  const size_t otherIndex) const
 {
-  const size_t pos = str.find(m_buf);
+  const Op &op = m_program[index], &otherOp = other.m_program[otherIndex];
+
+  // identical terms
+  const size_t size = op.end - index;
+  if(otherOp.end - otherIndex == size &&
+      std::equal(m_program.begin() + index, m_program.begin() + op.end,
+        other.m_program.begin() + otherIndex,
+        [&](const Op &a, const Op &b) {
+          return a.type == b.type && a.flags == b.flags &&
+            a.end - index == b.end - otherIndex && a.needle == b.needle;
+        }))
+    return true;
+
+  if(op.type != Op::Token || otherOp.type != Op::Token)
+    return false;
 
-  if(pos == std::string::npos)
+  const int flags = otherOp.flags;
+  const bool wordMatch = (flags & Node::QuotedFlag) && !(flags & Node::PhraseFlag),
+             fullMatch = (flags & Node::StartAnchorFlag) && (flags & Node::EndAnchorFlag);
+
+  // a longer needle matches somewhere else than the word or whole value
+  // the other one required
+  if((op.flags | flags) & Node::NotFlag || wordMatch || fullMatch)
     return false;
 
-  const bool isStart = pos == 0, isEnd = pos + m_buf.size() == str.size();
+  const size_t pos = op.needle.find(otherOp.needle);
 
-  if(test(StartAnchorFlag) && !isStart)
+  if(pos == std::string::npos)
     return false;
-  if(test(EndAnchorFlag) && !isEnd)
+  if(flags & Node::StartAnchorFlag &&
+      (!(op.flags & Node::StartAnchorFlag) || pos != 0))
+    return false;
+  if(flags & Node::EndAnchorFlag &&
+      (!(op.flags & Node::EndAnchorFlag) ||
+       op.needle.compare(op.needle.size() - otherOp.needle.size(),
+         std::string::npos, otherOp.needle) != 0))
     return false;
-  if(test(QuotedFlag) && !test(PhraseFlag)) {
-    return
-      (isStart || !isalnum(str[pos - 1])) &&
-      (isEnd || !isalnum(str[pos + m_buf.size()]));
-  }
 
   return true;
 }
+
+void Filter::Group::compile(std::vector<Op> *program) const
+{
+  const size_t index = program->size();
+  program->push_back({m_type == MatchAll ? Op::MatchAll : Op::MatchAny, m_flags, 0, {}});
+
+  for(const auto &node : m_nodes)
+    node->compile(program);
+
+  (*program)[index].end = program->size();
+}
+
+Filter::Token::Token(const std::string &buf, int flags)
+  : Node(flags), m_buf(String::fold(buf))
+{
+}
+
+void Filter::Token::compile(std::vector<Op> *program) const
+{
+  program->push_back({Op::Token, m_flags, program->size() + 1, m_buf});
+}
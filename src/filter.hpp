@@ -24,18 +24,41 @@
 
 class Filter {
 public:
+  // Case-folded values to match filters against, to be prepared only once
+  // for all the filters a row is matched against (eg. at every keystroke).
+  class Text {
+  public:
+    explicit Text(const std::vector<std::string> &values);
+
+  private:
+    friend Filter;
+
+    std::string m_buffer; // values separated by null characters
+    size_t m_count;
+  };
+
   Filter(const std::string & = {});
 
   const std::string get() const { return m_input; }
   void set(const std::string &);
 
-  bool match(std::vector<std::string> rows) const;
+  bool match(const std::vector<std::string> &rows) const { return match(Text(rows)); }
+  bool match(const Text &) const;
+
+  // Whether everything matching this filter also matches the other one
+  // (eg. after typing one more character). May give false negatives.
+  bool implies(const Filter &) const;
+
+  // Case-folded strings found in one of the values of any matching text.
+  std::vector<std::string> requiredTerms() const;
 
   Filter &operator=(const std::string &f) { set(f); return *this; }
   bool operator==(const std::string &f) const { return m_input == f; }
   bool operator!=(const std::string &f) const { return !(*this == f); }
 
 private:
+  struct Op;
+
   class Node {
   public:
     enum Flag {
@@ -49,10 +72,10 @@ private:
     Node(int flags) : m_flags(flags) {}
     virtual ~Node() = default;
 
-    virtual bool match(const std::vector<std::string> &) const = 0;
+    virtual void compile(std::vector<Op> *) const = 0;
     bool test(Flag f) const { return (m_flags & f) != 0; }
 
-  private:
+  protected:
     int m_flags;
   };
 
@@ -67,7 +90,7 @@ private:
     void clear() { m_nodes.clear(); }
     Group *push(std::string, int *flags);
 
-    bool match(const std::vector<std::string> &) const override;
+    void compile(std::vector<Op> *) const override;
 
   private:
     Group *addSubGroup(Type, int flags);
@@ -81,15 +104,31 @@ private:
   class Token : public Node {
   public:
     Token(const std::string &buf, int flags);
-    bool match(const std::vector<std::string> &) const override;
-    bool matchRow(const std::string &) const;
+    void compile(std::vector<Op> *) const override;
 
   private:
     std::string m_buf;
   };
 
+  // The parsed filter flattened in pre-order: a group is followed by its
+  // children and knows where its last one ends, so that matching
+  // only walks an array.
+  struct Op {
+    enum Type { Token, MatchAll, MatchAny };
+
+    Type type;
+    int flags;
+    size_t end; // index of the next op after this one and its children
+    std::string needle;
+  };
+
+  bool match(size_t op, const Text &) const;
+  bool matchToken(const Op &, const Text &) const;
+  bool implies(size_t op, const Filter &, size_t otherOp) const;
+
   std::string m_input;
   Group m_root;
+  std::vector<Op> m_program;
 };
 
 #endif
@@ -17,7 +17,12 @@
 
 #include "hash.hpp"
 
+#include "blake3.hpp"
+#include "filesystem.hpp"
+#include "sha256.hpp"
+
 #include <cstdio>
+#include <fstream>
 #include <vector>
 
 #ifdef _WIN32
@@ -148,19 +153,43 @@ private:
 
 #endif
 
+class Hash::BLAKE3Context : public Hash::Context {
+public:
+  size_t hashSize() const override
+  {
+    return ::BLAKE3::DIGEST_SIZE;
+  }
+
+  void addData(const char *data, const size_t len) override
+  {
+    m_context.addData(data, len);
+  }
+
+  void getHash(unsigned char *out) override
+  {
+    m_context.getHash(out);
+  }
+
+private:
+  ::BLAKE3 m_context;
+};
+
 Hash::Hash(const Algorithm algo)
   : m_algo(algo)
 {
-#ifdef _WIN32
-  if(const auto &algoProvider = CNGAlgorithmProvider::get(algo))
-    m_context = std::make_unique<CNGContext>(algoProvider);
-#else
   switch(algo) {
   case SHA256:
+#ifdef _WIN32
+    if(const auto &algoProvider = CNGAlgorithmProvider::get(algo))
+      m_context = std::make_unique<CNGContext>(algoProvider);
+#else
     m_context = std::make_unique<SHA256Context>();
+#endif
+    break;
+  case BLAKE3:
+    m_context = std::make_unique<BLAKE3Context>();
     break;
   }
-#endif
 }
 
 void Hash::addData(const char *data, const size_t len)
@@ -174,21 +203,64 @@ const std::string &Hash::digest()
   if(!m_context || !m_value.empty())
     return m_value;
 
-  // Assuming m_algo and hashSize can fit in one byte. We'll need to implement
-  // multihash's varint if we need larger values in the future.
   const size_t hashSize = m_context->hashSize();
+  std::vector<unsigned char> raw(hashSize);
+  m_context->getHash(raw.data());
+
+  m_value = multihash(m_algo, raw.data(), hashSize);
+  return m_value;
+}
 
-  std::vector<unsigned char> multihash(2 + hashSize);
-  multihash[0] = m_algo;
-  multihash[1] = static_cast<unsigned char>(hashSize);
-  m_context->getHash(&multihash[2]);
+std::string Hash::multihash(const Algorithm algo,
+  const unsigned char *raw, const size_t size)
+{
+  // Assuming algo and size can fit in one byte. We'll need to implement
+  // multihash's varint if we need larger values in the future.
+  static const char hex[] = "0123456789abcdef";
 
-  m_value.resize(multihash.size() * 2);
+  std::string value((2 + size) * 2, '\0');
+  const auto put = [&](const size_t i, const unsigned char byte) {
+    value[i * 2] = hex[byte >> 4];
+    value[i * 2 + 1] = hex[byte & 0xf];
+  };
 
-  for(size_t i = 0; i < multihash.size(); ++i)
-    sprintf(&m_value[i * 2], "%02x", multihash[i]);
+  put(0, static_cast<unsigned char>(algo));
+  put(1, static_cast<unsigned char>(size));
 
-  return m_value;
+  for(size_t i = 0; i < size; ++i)
+    put(2 + i, raw[i]);
+
+  return value;
+}
+
+std::vector<std::string> Hash::digestMany(const Algorithm algo,
+  const std::vector<std::string_view> &buffers)
+{
+  std::vector<std::string> digests;
+  digests.reserve(buffers.size());
+
+  switch(algo) {
+  case SHA256: {
+    std::vector<unsigned char> raw(buffers.size() * ::SHA256::DIGEST_SIZE);
+
+    ::SHA256::hashMany(buffers.data(), buffers.size(), raw.data());
+
+    for(size_t i = 0; i < buffers.size(); ++i) {
+      digests.emplace_back(multihash(algo,
+        &raw[i * ::SHA256::DIGEST_SIZE], ::SHA256::DIGEST_SIZE));
+    }
+    break;
+  }
+  default:
+    for(const std::string_view &buffer : buffers) {
+      Hash hash(algo);
+      hash.addData(buffer.data(), buffer.size());
+      digests.emplace_back(hash.digest());
+    }
+    break;
+  }
+
+  return digests;
 }
 
 bool Hash::getAlgorithm(const std::string &hash, Algorithm *out)
@@ -202,9 +274,42 @@ bool Hash::getAlgorithm(const std::string &hash, Algorithm *out)
 
   switch(algo) {
   case SHA256:
+  case BLAKE3:
     *out = static_cast<Algorithm>(algo);
     return true;
   default:
     return false;
   };
 }
+
+bool Hash::verify(const Path &file, const std::string &checksum)
+{
+  Algorithm algo;
+  std::string actual;
+
+  return getAlgorithm(checksum, &algo) &&
+    fromFile(file, algo, &actual) && actual == checksum;
+}
+
+bool Hash::fromFile(const Path &file, const Algorithm algo, std::string *checksum)
+{
+  std::ifstream stream;
+  if(!FS::open(stream, file))
+    return false;
+
+  Hash hash(algo);
+
+  // BLAKE3 hashes larger reads as whole subtrees across multiple threads
+  std::vector<char> buffer(algo == BLAKE3 ? 4 * 1024 * 1024 : 64 * 1024);
+
+  while(stream) {
+    stream.read(buffer.data(), buffer.size());
+    hash.addData(buffer.data(), static_cast<size_t>(stream.gcount()));
+  }
+
+  if(stream.bad())
+    return false;
+
+  *checksum = hash.digest();
+  return true;
+}
@@ -20,14 +20,23 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
+
+class Path;
 
 class Hash {
 public:
   enum Algorithm {
     SHA256 = 0x12,
+    BLAKE3 = 0x1e,
   };
 
   static bool getAlgorithm(const std::string &hash, Algorithm *out);
+  static bool verify(const Path &file, const std::string &checksum);
+  static bool fromFile(const Path &file, Algorithm, std::string *checksum);
+  static std::vector<std::string> digestMany(Algorithm,
+    const std::vector<std::string_view> &buffers);
 
   Hash(Algorithm);
   Hash(const Hash &) = delete;
@@ -46,6 +55,9 @@ private:
 
   class CNGContext;
   class SHA256Context;
+  class BLAKE3Context;
+
+  static std::string multihash(Algorithm, const unsigned char *raw, size_t size);
 
   Algorithm m_algo;
   std::string m_value;
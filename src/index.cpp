@@ -21,6 +21,7 @@
 #include "filesystem.hpp"
 #include "path.hpp"
 #include "remote.hpp"
+#include "searchindex.hpp"
 
 #include <WDL/tinyxml/tinyxml.h>
 
@@ -117,6 +118,15 @@ bool Index::addCategory(const Category *cat)
   return true;
 }
 
+const SearchIndex &Index::searchIndex() const
+{
+  call_once(m_searchIndexOnce, [this] {
+    m_searchIndex = make_unique<SearchIndex>(*this);
+  });
+
+  return *m_searchIndex;
+}
+
 const Category *Index::category(const string &name) const
 {
   const auto &it = m_catMap.find(name);
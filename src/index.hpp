@@ -24,6 +24,7 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -31,6 +32,7 @@
 class Index;
 class Path;
 class Remote;
+class SearchIndex;
 class TiXmlElement;
 struct NetworkOpts;
 
@@ -58,6 +60,9 @@ public:
 
   const std::vector<const Package *> &packages() const { return m_packages; }
 
+  // built on first use and kept for as long as this index is loaded
+  const SearchIndex &searchIndex() const;
+
 private:
   static void loadV1(TiXmlElement *, Index *);
 
@@ -67,6 +72,9 @@ private:
   std::vector<const Package *> m_packages;
 
   std::unordered_map<std::string, size_t> m_catMap;
+
+  mutable std::once_flag m_searchIndexOnce;
+  mutable std::unique_ptr<SearchIndex> m_searchIndex;
 };
 
 class Category {
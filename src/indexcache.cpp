@@ -0,0 +1,98 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2019  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "indexcache.hpp"
+
+#include "errors.hpp"
+#include "index.hpp"
+
+using namespace std;
+
+IndexCache::IndexCache(const size_t budget)
+  : m_budget(budget), m_usage(0)
+{
+}
+
+IndexPtr IndexCache::load(const string &name)
+{
+  lock_guard<mutex> guard(m_mutex);
+
+  FS::FileInfo file;
+  if(!FS::getInfo(Index::pathFor(name), &file))
+    throw reapack_error(FS::lastError());
+
+  const auto it = m_map.find(name);
+
+  if(it != m_map.end()) {
+    if(it->second->file == file) {
+      m_entries.splice(m_entries.begin(), m_entries, it->second);
+      return it->second->index;
+    }
+
+    erase(it->second);
+  }
+
+  const IndexPtr &index = Index::load(name);
+
+  m_entries.push_front({name, file, index});
+  m_map[name] = m_entries.begin();
+  m_usage += static_cast<size_t>(file.size);
+
+  evict();
+
+  return index;
+}
+
+void IndexCache::invalidate(const string &name)
+{
+  lock_guard<mutex> guard(m_mutex);
+
+  const auto it = m_map.find(name);
+  if(it != m_map.end())
+    erase(it->second);
+}
+
+void IndexCache::clear()
+{
+  lock_guard<mutex> guard(m_mutex);
+
+  m_map.clear();
+  m_entries.clear();
+  m_usage = 0;
+}
+
+void IndexCache::setBudget(const size_t budget)
+{
+  lock_guard<mutex> guard(m_mutex);
+
+  m_budget = budget;
+  evict();
+}
+
+void IndexCache::erase(const EntryIt it)
+{
+  m_usage -= static_cast<size_t>(it->file.size);
+  m_map.erase(it->name);
+  m_entries.erase(it);
+}
+
+void IndexCache::evict()
+{
+  // always keep the index that was just loaded
+  while(m_usage > m_budget && m_entries.size() > 1)
+    erase(prev(m_entries.end()));
+}
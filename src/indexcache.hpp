@@ -0,0 +1,69 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2019  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REAPACK_INDEXCACHE_HPP
+#define REAPACK_INDEXCACHE_HPP
+
+#include "filesystem.hpp"
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+class Index;
+typedef std::shared_ptr<const Index> IndexPtr;
+
+// Shares the parsed repository indexes between transactions and dialogs.
+// Entries are reloaded when the file changes on disk and the least recently
+// used ones are dropped when the total size of their files exceeds the budget.
+class IndexCache {
+public:
+  static constexpr size_t DEFAULT_BUDGET = 64 * 1024 * 1024;
+
+  IndexCache(size_t budget = DEFAULT_BUDGET);
+  IndexCache(const IndexCache &) = delete;
+
+  IndexPtr load(const std::string &name);
+  void invalidate(const std::string &name);
+  void clear();
+
+  void setBudget(size_t);
+  size_t usage() const { return m_usage; }
+  size_t size() const { return m_map.size(); }
+
+private:
+  struct Entry {
+    std::string name;
+    FS::FileInfo file;
+    IndexPtr index;
+  };
+
+  typedef std::list<Entry>::iterator EntryIt;
+
+  void erase(EntryIt);
+  void evict();
+
+  size_t m_budget;
+  size_t m_usage;
+  std::list<Entry> m_entries; // most recently used first
+  std::unordered_map<std::string, EntryIt> m_map;
+  std::mutex m_mutex;
+};
+
+#endif
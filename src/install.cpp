@@ -58,38 +58,82 @@ bool InstallTask::start()
     return false;
   }
 
+  unordered_set<Path> newFiles;
+
   for(const Source *src : m_version->sources()) {
     const Path &targetPath = src->targetPath();
+    newFiles.insert(targetPath);
 
-    const auto &old = find_if(m_oldFiles.begin(), m_oldFiles.end(),
-      [&](const Registry::File &f) { return f.path == targetPath; });
-
-    if(old != m_oldFiles.end())
-      m_oldFiles.erase(old);
+    // repairing only replaces the given files
+    if(!m_only.empty() && !m_only.count(targetPath))
+      continue;
 
+    // the checksums must be known before push() may commit this task
     if(m_reader) {
       FileExtractor *ex = new FileExtractor(targetPath, m_reader);
+      ex->onFinishAsync >> [=] { m_checksums[targetPath] = ex->checksum(); };
       push(ex, ex->path());
     }
     else {
       const NetworkOpts &opts = g_reapack->config()->network;
       FileDownload *dl = new FileDownload(targetPath, src->url(), opts);
       dl->setExpectedChecksum(src->checksum());
-      push(dl, dl->path());
+      dl->setReuseTemp(tx()->journal()->contains(dl->path(), src->checksum()));
+      dl->onFinishAsync >> [=] {
+        m_checksums[targetPath] = dl->checksum();
+        if(dl->unchanged())
+          m_unchanged.insert(targetPath);
+      };
+      push(dl, dl->path(), src->checksum());
+    }
+  }
+
+  // old files not overwritten by the new version are removed in commit()
+  // the others keep their recorded checksum unless they are replaced
+  for(auto it = m_oldFiles.begin(); it != m_oldFiles.end();) {
+    if(newFiles.count(it->path)) {
+      if(!m_only.empty() && !m_only.count(it->path))
+        m_keptFiles.push_back(*it);
+
+      it = m_oldFiles.erase(it);
     }
+    else
+      ++it;
   }
 
   return true;
 }
 
-void InstallTask::push(ThreadTask *job, const TempPath &path)
+void InstallTask::reserve()
+{
+  // nothing will be installed: don't make later queues conflict with it
+  if(m_fail)
+    return;
+
+  // the conflicts were already reported when this task was started
+  vector<Path> conflicts;
+  tx()->registry()->push(m_version, &conflicts);
+}
+
+void InstallTask::push(ThreadTask *job, const TempPath &path,
+  const string &checksum)
 {
   job->onStartAsync >> [=] { m_newFiles.push_back(path); };
   job->onFinishAsync >> [=] {
     m_waiting.erase(job);
 
-    if(job->state() != ThreadTask::Success)
+    // keep verified downloads for the next transaction if this one is cancelled
+    // (targets already matching their checksum have nothing to keep)
+    if(job->state() != ThreadTask::Success) {
+      tx()->journal()->remove(path);
       rollback();
+    }
+    else if(!m_unchanged.count(path.target()))
+      tx()->journal()->add(path, checksum);
+
+    // install the package without waiting for the rest of the transaction
+    if(m_waiting.empty())
+      tx()->commitReady();
   };
 
   m_waiting.insert(job);
@@ -102,7 +146,9 @@ void InstallTask::commit()
     return;
 
   for(const TempPath &paths : m_newFiles) {
-    if(!FS::rename(paths)) {
+    if(m_unchanged.count(paths.target()))
+      continue;
+    else if(!FS::rename(paths)) {
       tx()->receipt()->addError({
         String::format("Cannot rename to target: %s", FS::lastError()),
         paths.target().join()});
@@ -112,6 +158,8 @@ void InstallTask::commit()
       rollback();
       return;
     }
+
+    tx()->journal()->remove(paths);
   }
 
   for(const Registry::File &file : m_oldFiles) {
@@ -125,6 +173,17 @@ void InstallTask::commit()
 
   const Registry::Entry newEntry = tx()->registry()->push(m_version);
 
+  for(const TempPath &paths : m_newFiles) {
+    FS::FileInfo info;
+    if(FS::getInfo(paths.target(), &info)) {
+      tx()->registry()->setChecksum(paths.target(),
+        m_checksums[paths.target()], info.size);
+    }
+  }
+
+  for(const Registry::File &file : m_keptFiles)
+    tx()->registry()->setChecksum(file.path, file.checksum, file.size);
+
   if(m_pin)
     tx()->registry()->setPinned(newEntry, true);
 
@@ -133,8 +192,10 @@ void InstallTask::commit()
 
 void InstallTask::rollback()
 {
-  for(const TempPath &paths : m_newFiles)
-    FS::removeRecursive(paths.temp());
+  for(const TempPath &paths : m_newFiles) {
+    if(!tx()->journal()->contains(paths))
+      FS::removeRecursive(paths.temp());
+  }
 
   for(ThreadTask *job : m_waiting)
     job->abort();
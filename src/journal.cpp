@@ -0,0 +1,132 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2019  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "journal.hpp"
+
+#include "filesystem.hpp"
+#include "hash.hpp"
+
+#include <cstdlib>
+
+using namespace std;
+
+Journal::Journal(const Path &path)
+  : m_path(path)
+{
+  ifstream stream;
+  if(!FS::open(stream, m_path))
+    return;
+
+  string line;
+  while(getline(stream, line)) {
+    // checksum <TAB> temporary file [<TAB> unused transaction count]
+    const size_t sep = line.find('\t');
+    if(sep == string::npos)
+      continue;
+
+    const size_t countSep = line.find('\t', sep + 1);
+    const string &checksum = line.substr(0, sep);
+    const Path temp(line.substr(sep + 1, countSep - sep - 1));
+    const unsigned int unused = countSep == string::npos ? 0 :
+      static_cast<unsigned int>(strtoul(line.c_str() + countSep + 1, nullptr, 10));
+
+    // ignore truncated or damaged entries and files deleted since
+    Hash::Algorithm algo;
+    if(!temp.empty() && Hash::getAlgorithm(checksum, &algo) && FS::exists(temp))
+      m_entries[temp] = {checksum, unused, false};
+  }
+}
+
+bool Journal::contains(const TempPath &path) const
+{
+  return m_entries.count(path.temp()) > 0;
+}
+
+bool Journal::contains(const TempPath &path, const string &checksum) const
+{
+  const auto it = m_entries.find(path.temp());
+  return it != m_entries.end() && it->second.checksum == checksum;
+}
+
+void Journal::add(const TempPath &path, const string &checksum)
+{
+  if(checksum.empty())
+    return; // cannot be verified before being reused
+  else if(contains(path, checksum)) {
+    m_entries[path.temp()].used = true;
+    return;
+  }
+
+  // rewrite the entries of the previous transactions on first use
+  if(!m_stream.is_open()) {
+    if(!FS::open(m_stream, m_path))
+      return;
+
+    for(const auto &[temp, entry] : m_entries)
+      write(temp, entry);
+  }
+
+  const Entry &entry = m_entries[path.temp()] = {checksum, 0, true};
+  write(path.temp(), entry);
+}
+
+void Journal::write(const Path &temp, const Entry &entry)
+{
+  // flushed immediately to survive a crash
+  m_stream << entry.checksum << '\t' << temp.join(false)
+    << '\t' << entry.unused << endl;
+}
+
+void Journal::remove(const TempPath &path)
+{
+  m_entries.erase(path.temp());
+}
+
+void Journal::save()
+{
+  m_stream.close();
+
+  for(auto it = m_entries.begin(); it != m_entries.end();) {
+    Entry &entry = it->second;
+
+    if(entry.used) {
+      entry.unused = 0;
+      entry.used = false;
+    }
+    // eg. a newer version was installed instead or the package is not wanted
+    else if(++entry.unused > MAX_UNUSED_TRANSACTIONS)
+      FS::remove(it->first);
+
+    if(entry.unused <= MAX_UNUSED_TRANSACTIONS && FS::exists(it->first))
+      ++it;
+    else
+      it = m_entries.erase(it);
+  }
+
+  if(m_entries.empty()) {
+    FS::remove(m_path);
+    return;
+  }
+
+  if(!FS::open(m_stream, m_path))
+    return;
+
+  for(const auto &[temp, entry] : m_entries)
+    write(temp, entry);
+
+  m_stream.close();
+}
@@ -0,0 +1,58 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2019  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REAPACK_JOURNAL_HPP
+#define REAPACK_JOURNAL_HPP
+
+#include "path.hpp"
+
+#include <fstream>
+#include <string>
+#include <unordered_map>
+
+// Remembers the temporary files that were completely downloaded and verified
+// but not installed yet (cancelled or interrupted transactions) so they can
+// be reused by the next transaction instead of being downloaded again.
+// Files left unused by a few transactions in a row are deleted.
+class Journal {
+public:
+  static constexpr unsigned int MAX_UNUSED_TRANSACTIONS = 3;
+
+  Journal(const Path &);
+  Journal(const Journal &) = delete;
+
+  bool contains(const TempPath &) const;
+  bool contains(const TempPath &, const std::string &checksum) const;
+  void add(const TempPath &, const std::string &checksum);
+  void remove(const TempPath &);
+  void save();
+
+private:
+  struct Entry {
+    std::string checksum;
+    unsigned int unused; // transactions finished without using the file
+    bool used;           // added again by the current transaction
+  };
+
+  void write(const Path &temp, const Entry &);
+
+  Path m_path;
+  std::unordered_map<Path, Entry> m_entries;
+  std::ofstream m_stream;
+};
+
+#endif
@@ -19,12 +19,17 @@
 
 #include "iconlist.hpp"
 #include "menu.hpp"
+#include "string.hpp"
 #include "time.hpp"
 #include "version.hpp"
 #include "win32.hpp"
 
-#include <boost/algorithm/string/case_conv.hpp>
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <limits>
+#include <numeric>
+#include <thread>
 
 using namespace std;
 
@@ -43,7 +48,8 @@ static int adjustWidth(const int points)
 }
 
 ListView::ListView(HWND handle, const Columns &columns)
-  : Control(handle), m_dirty(0), m_customizable(false), m_sort(), m_defaultSort()
+  : Control(handle), m_dirty(0), m_filterStats{}, m_customizable(false),
+    m_sort(), m_defaultSort()
 {
   for(const Column &col : columns)
     addColumn(col);
@@ -180,30 +186,82 @@ int ListView::columnWidth(const int index) const
   return ListView_GetColumnWidth(handle(), index);
 }
 
-void ListView::sort()
+int ListView::compareRows(const int aRow, const int bRow) const
 {
-  static const auto compare = [](LPARAM aRow, LPARAM bRow, LPARAM param)
-  {
-    const int indexDiff = (int)(aRow - bRow);
+  const int indexDiff = aRow - bRow;
+
+  if(!m_sort)
+    return indexDiff;
+
+  const int columnIndex = m_sort->column;
+  const Column &column = m_cols[columnIndex];
+
+  int ret = column.compare(row(aRow)->cell(columnIndex),
+    row(bRow)->cell(columnIndex));
+
+  if(m_sort->order == DescendingOrder)
+    ret = -ret;
+
+  return ret ? ret : indexDiff;
+}
+
+void ListView::sortRows(vector<int> &rows) const
+{
+  constexpr size_t MIN_CHUNK_SIZE = 10000;
 
-    ListView *view = reinterpret_cast<ListView *>(param);
+  const auto less = [this](const int a, const int b) {
+    return compareRows(a, b) < 0;
+  };
+
+  const size_t chunks = min<size_t>(
+    thread::hardware_concurrency(), rows.size() / MIN_CHUNK_SIZE);
+
+  if(chunks < 2) {
+    std::sort(rows.begin(), rows.end(), less);
+    return;
+  }
 
-    if(!view->m_sort)
-      return indexDiff;
+  // sort the chunks in parallel, then merge them pairwise
+  vector<size_t> bounds(chunks + 1);
+  for(size_t i = 0; i <= chunks; ++i)
+    bounds[i] = rows.size() * i / chunks;
 
-    const int columnIndex = view->m_sort->column;
-    const Column &column = view->m_cols[columnIndex];
+  vector<thread> workers;
+  for(size_t i = 0; i < chunks; ++i) {
+    workers.emplace_back([&, i] {
+      std::sort(rows.begin() + bounds[i], rows.begin() + bounds[i + 1], less);
+    });
+  }
 
-    int ret = column.compare(view->row(aRow)->cell(columnIndex),
-      view->row(bRow)->cell(columnIndex));
+  for(thread &worker : workers)
+    worker.join();
 
-    if(view->m_sort->order == DescendingOrder)
-      ret = -ret;
+  for(size_t width = 1; width < chunks; width *= 2) {
+    for(size_t i = 0; i + width < chunks; i += width * 2) {
+      inplace_merge(rows.begin() + bounds[i], rows.begin() + bounds[i + width],
+        rows.begin() + bounds[min(i + width * 2, chunks)], less);
+    }
+  }
+}
 
-    return ret ? ret : indexDiff;
+void ListView::sort()
+{
+  static const auto compare = [](LPARAM aRow, LPARAM bRow, LPARAM param)
+  {
+    const vector<int> &rank = *reinterpret_cast<const vector<int> *>(param);
+    return rank[aRow] - rank[bRow];
   };
 
-  ListView_SortItems(handle(), compare, (LPARAM)this);
+  // the control only has to move its items to their precomputed rank
+  vector<int> order(rowCount());
+  iota(order.begin(), order.end(), 0);
+  sortRows(order);
+
+  vector<int> rank(order.size());
+  for(int i = 0; i < (int)order.size(); ++i)
+    rank[order[i]] = i;
+
+  ListView_SortItems(handle(), compare, (LPARAM)&rank);
 
   m_dirty = (m_dirty | NeedReindexFlag) & ~NeedSortFlag;
 }
@@ -254,12 +312,21 @@ void ListView::setSortArrow(const bool set)
 
 void ListView::filter()
 {
+  const auto startTime = chrono::steady_clock::now();
+  const bool narrow = !(m_dirty & NeedFilterFlag);
+  int tested = 0;
+
   vector<int> hide;
 
   for(int ri = 0; ri < rowCount(); ++ri) {
     RowPtr &row = m_rows[ri];
 
-    if(m_filter.match(row->filterValues())) {
+    if(narrow && row->viewIndex == -1)
+      continue;
+
+    ++tested;
+
+    if((!m_prefilter || m_prefilter(*row)) && m_filter.match(row->filterText())) {
       if(row->viewIndex == -1) {
         row->viewIndex = visibleRowCount();
         insertItem(row->viewIndex, ri);
@@ -282,15 +349,26 @@ void ListView::filter()
     m_dirty |= NeedReindexFlag;
   }
 
-  m_dirty &= ~NeedFilterFlag;
+  m_dirty &= ~(NeedFilterFlag | NarrowFilterFlag);
+
+  const chrono::duration<double, milli> duration =
+    chrono::steady_clock::now() - startTime;
+  m_filterStats = {tested, narrow, duration.count()};
 }
 
-void ListView::setFilter(const string &newFilter)
+void ListView::setFilter(const string &newFilter, const Prefilter &prefilter)
 {
+  // the prefilter only skips rows that would not match anyway
+  m_prefilter = prefilter;
+
   if(m_filter != newFilter) {
     ListView::BeginEdit edit(this);
+
+    // the hidden rows cannot match a refined filter (eg. a longer word)
+    const Filter filter(newFilter);
+    m_dirty |= filter.implies(m_filter) ? NarrowFilterFlag : NeedFilterFlag;
+
     m_filter = newFilter;
-    m_dirty |= NeedFilterFlag;
   }
 }
 
@@ -311,7 +389,7 @@ void ListView::reindexVisible()
 
 void ListView::endEdit()
 {
-  if(m_dirty & NeedFilterFlag)
+  if(m_dirty & (NeedFilterFlag | NarrowFilterFlag))
     filter(); // filter may set NeedSortFlag
   if(m_dirty & NeedSortFlag)
     sort(); // sort may set NeedReindexFlag
@@ -669,33 +747,32 @@ void ListView::saveState(Serializer::Data &data) const
     data.push_back({order[i], columnWidth(i)});
 }
 
-int ListView::Column::compare(const ListView::Cell &cl, const ListView::Cell &cr) const
+auto ListView::Column::sortKey(const string &value, const void *data) const
+  -> Cell::SortKey
 {
-  if(dataType) {
-    if(!cl.userData)
-      return -1;
-    else if(!cr.userData)
-      return 1;
-  }
+  if(dataType && !data) // cells without data go first
+    return {numeric_limits<int64_t>::min(), {}};
 
   switch(dataType) {
-  case UserType: { // arbitrary data or no data: sort by visible text
-    string l = cl.value, r = cr.value;
-
-    boost::algorithm::to_lower(l);
-    boost::algorithm::to_lower(r);
-
-    return l.compare(r);
-  }
+  case UserType: // arbitrary data or no data: sort by visible text
+    return {0, String::fold(value)};
   case VersionType:
-    return static_cast<const VersionName *>(cl.userData)->compare(
-      *static_cast<const VersionName *>(cr.userData));
+    return {0, static_cast<const VersionName *>(data)->sortKey()};
   case TimeType:
-    return static_cast<const Time *>(cl.userData)->compare(
-      *static_cast<const Time *>(cr.userData));
+    return {static_cast<const Time *>(data)->sortKey(), {}};
   }
 
-  return 0; // to make MSVC happy
+  return {}; // to make MSVC happy
+}
+
+int ListView::Column::compare(const ListView::Cell &cl, const ListView::Cell &cr) const
+{
+  const Cell::SortKey &l = cl.sortKey, &r = cr.sortKey;
+
+  if(l.number != r.number)
+    return l.number < r.number ? -1 : 1;
+
+  return l.text.compare(r.text);
 }
 
 ListView::Row::Row(void *data, ListView *list)
@@ -709,6 +786,10 @@ void ListView::Row::setCell(const int i, const string &val, void *data)
   Cell &cell = m_cells[i];
   cell.value = val;
   cell.userData = data;
+  cell.sortKey = m_list->column(i).sortKey(val, data);
+
+  if(m_list->column(i).test(FilterFlag))
+    m_filterText.reset();
 
   m_list->updateCell(userIndex, i);
 }
@@ -718,14 +799,18 @@ void ListView::Row::setChecked(bool checked)
   m_list->setRowIcon(userIndex, checked);
 }
 
-vector<string> ListView::Row::filterValues() const
+const Filter::Text &ListView::Row::filterText() const
 {
-  vector<string> values;
+  if(!m_filterText) {
+    vector<string> values;
+
+    for(int ci = 0; ci < m_list->columnCount(); ++ci) {
+      if(m_list->column(ci).test(FilterFlag))
+        values.push_back(m_cells[ci].value);
+    }
 
-  for(int ci = 0; ci < m_list->columnCount(); ++ci) {
-    if(m_list->column(ci).test(FilterFlag))
-      values.push_back(m_cells[ci].value);
+    m_filterText.emplace(values);
   }
 
-  return values;
+  return *m_filterText;
 }
@@ -24,6 +24,7 @@
 #include "filter.hpp"
 #include "serializer.hpp"
 
+#include <cstdint>
 #include <functional>
 #include <optional>
 #include <vector>
@@ -47,11 +48,17 @@ public:
   };
 
   struct Cell {
-    Cell() : userData(nullptr) {}
+    struct SortKey {
+      std::int64_t number;
+      std::string text;
+    };
+
+    Cell() : userData(nullptr), sortKey{} {}
     Cell(const Cell &) = delete;
 
     std::string value;
     void *userData;
+    SortKey sortKey; // computed by the column when the cell is set
   };
 
   class Row {
@@ -68,7 +75,8 @@ public:
     void setCell(const int i, const std::string &, void *data = nullptr);
     void setChecked(bool check = true);
 
-    std::vector<std::string> filterValues() const;
+    // case-folded values of the filterable columns, kept until a cell changes
+    const Filter::Text &filterText() const;
 
   protected:
     friend ListView;
@@ -78,6 +86,7 @@ public:
   private:
     ListView *m_list;
     Cell *m_cells;
+    mutable std::optional<Filter::Text> m_filterText;
   };
 
   typedef std::shared_ptr<Row> RowPtr;
@@ -89,6 +98,7 @@ public:
     ColumnDataType dataType;
 
     bool test(ColumnFlag f) const { return (flags & f) != 0; }
+    Cell::SortKey sortKey(const std::string &value, const void *data) const;
     int compare(const Cell &, const Cell &) const;
   };
 
@@ -106,6 +116,15 @@ public:
 
   typedef std::vector<Column> Columns;
 
+  // rows rejected by a prefilter are hidden without testing the filter
+  typedef std::function<bool (const Row &)> Prefilter;
+
+  struct FilterStats {
+    int tested;      // rows matched against the filter
+    bool narrowed;   // only the rows that were visible got tested
+    double duration; // in milliseconds
+  };
+
   ListView(HWND handle, const Columns & = {});
 
   void reserveRows(size_t count) { m_rows.reserve(count); }
@@ -143,7 +162,8 @@ public:
   int columnCount() const { return (int)m_cols.size(); }
 
   void sortByColumn(int index, SortOrder order = AscendingOrder, bool user = false);
-  void setFilter(const std::string &);
+  void setFilter(const std::string &, const Prefilter & = {});
+  const FilterStats &filterStats() const { return m_filterStats; }
   void endEdit();
 
   void restoreState(Serializer::Data &);
@@ -174,6 +194,7 @@ private:
     NeedSortFlag    = 1<<0,
     NeedReindexFlag = 1<<1,
     NeedFilterFlag  = 1<<2,
+    NarrowFilterFlag = 1<<3, // only the visible rows may have stopped matching
   };
 
   void onNotify(LPNMHDR, LPARAM) override;
@@ -188,12 +209,16 @@ private:
   int translateBack(int internalIndex) const;
   void headerMenu(int x, int y);
   void insertItem(int viewIndex, int rowIndex);
+  int compareRows(int aRow, int bRow) const;
+  void sortRows(std::vector<int> &) const;
   void sort();
   void reindexVisible();
   void filter();
 
   int m_dirty;
   Filter m_filter;
+  Prefilter m_prefilter;
+  FilterStats m_filterStats;
 
   bool m_customizable;
   std::vector<Column> m_cols;
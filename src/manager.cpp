@@ -44,7 +44,8 @@ enum {
   ACTION_AUTOINSTALL_OFF, ACTION_AUTOINSTALL_ON, ACTION_AUTOINSTALL,
   ACTION_BLEEDINGEDGE, ACTION_PROMPTOBSOLETE, ACTION_NETCONFIG,
   ACTION_RESETCONFIG, ACTION_IMPORT_REPO, ACTION_IMPORT_ARCHIVE,
-  ACTION_EXPORT_ARCHIVE,
+  ACTION_EXPORT_ARCHIVE, ACTION_EXPORT_INCREMENTAL, ACTION_COMPRESSION_FAST,
+  ACTION_COMPRESSION_DEFAULT, ACTION_COMPRESSION_SMALL,
 };
 
 enum { TIMER_ABOUT = 1, };
@@ -150,7 +151,19 @@ void Manager::onCommand(const int id, int)
     importArchive();
     break;
   case ACTION_EXPORT_ARCHIVE:
-    exportArchive();
+    exportArchive(false);
+    break;
+  case ACTION_EXPORT_INCREMENTAL:
+    exportArchive(true);
+    break;
+  case ACTION_COMPRESSION_FAST:
+    setCompression(ArchiveOpts::FastCompression);
+    break;
+  case ACTION_COMPRESSION_DEFAULT:
+    setCompression(ArchiveOpts::DefaultCompression);
+    break;
+  case ACTION_COMPRESSION_SMALL:
+    setCompression(ArchiveOpts::SmallCompression);
     break;
   case ACTION_AUTOINSTALL:
     toggle(m_autoInstall, g_reapack->config()->install.autoInstall);
@@ -471,6 +484,14 @@ void Manager::importExport()
   menu.addSeparator();
   menu.addAction("Import offline archive...", ACTION_IMPORT_ARCHIVE);
   menu.addAction("&Export offline archive...", ACTION_EXPORT_ARCHIVE);
+  menu.addAction("Export &incremental archive...", ACTION_EXPORT_INCREMENTAL);
+
+  Menu compression = menu.addMenu("Export &compression");
+  const UINT fast = compression.addAction(
+    "&Faster (larger archive)", ACTION_COMPRESSION_FAST);
+  compression.addAction("&Balanced", ACTION_COMPRESSION_DEFAULT);
+  compression.addAction("&Smaller (slower)", ACTION_COMPRESSION_SMALL);
+  compression.checkRadio(fast + g_reapack->config()->archive.compression);
 
   menu.show(getControl(IDC_IMPORT), handle());
 }
@@ -507,19 +528,40 @@ void Manager::importArchive()
   }
 }
 
-void Manager::exportArchive()
+void Manager::exportArchive(const bool incremental)
 {
+  string basePath;
+  Path directory = Path::DATA.prependRoot();
+
+  // incremental archives only contain the files changed since the base
+  if(incremental) {
+    basePath = FileDialog::getOpenFileName(handle(), instance(),
+      "Select base archive", directory, ARCHIVE_FILTER, ARCHIVE_EXT);
+
+    if(basePath.empty())
+      return;
+
+    // the base must be stored next to the incremental archive
+    directory = Path(basePath).dirname();
+  }
+
   const string &path = FileDialog::getSaveFileName(handle(), instance(),
-    "Export offline archive", Path::DATA.prependRoot(), ARCHIVE_FILTER, ARCHIVE_EXT);
+    "Export offline archive", directory, ARCHIVE_FILTER, ARCHIVE_EXT);
 
   if(!path.empty()) {
     if(Transaction *tx = g_reapack->setupTransaction()) {
-      tx->exportArchive(path);
+      tx->exportArchive(path, basePath);
       tx->runTasks();
     }
   }
 }
 
+void Manager::setCompression(const ArchiveOpts::Compression compression)
+{
+  g_reapack->config()->archive.compression = compression;
+  g_reapack->config()->write();
+}
+
 void Manager::launchBrowser()
 {
   const auto promptApply = [this] {
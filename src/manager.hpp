@@ -18,6 +18,7 @@
 #ifndef REAPACK_MANAGER_HPP
 #define REAPACK_MANAGER_HPP
 
+#include "config.hpp"
 #include "dialog.hpp"
 
 #include <boost/logic/tribool.hpp>
@@ -27,7 +28,6 @@
 class ListView;
 class Menu;
 class Remote;
-struct NetworkOpts;
 
 typedef boost::logic::tribool tribool;
 
@@ -69,8 +69,9 @@ private:
   void importExport();
   void options();
   void setupNetwork();
+  void setCompression(ArchiveOpts::Compression);
   void importArchive();
-  void exportArchive();
+  void exportArchive(bool incremental);
   void aboutRepo(bool focus = true);
 
   void setChange(int);
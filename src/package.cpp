@@ -21,7 +21,7 @@
 #include "index.hpp"
 
 #include <algorithm>
-#include <boost/range/adaptor/reversed.hpp>
+#include <cstring>
 
 using namespace std;
 
@@ -87,7 +87,7 @@ const string &Package::displayName(const string &name, const string &desc)
 }
 
 Package::Package(const Type type, const string &name, const Category *cat)
-  : m_category(cat), m_type(type), m_name(name)
+  : m_category(cat), m_type(type), m_name(name), m_lastStable(nullptr)
 {
   if(m_name.empty())
     throw reapack_error("empty package name");
@@ -114,22 +114,25 @@ bool Package::addVersion(const Version *ver)
     throw reapack_error("version belongs to another package");
   else if(ver->sources().empty())
     return false;
-  else if(m_versions.count(ver)) {
+
+  // versions are usually listed in ascending order in the index,
+  // so this is typically an insertion at the end
+  const auto &it = upper_bound(m_versions.begin(), m_versions.end(), ver,
+    [](const Version *l, const Version *r) { return l->name() < r->name(); });
+
+  if(it != m_versions.begin() && (*prev(it))->name() == ver->name()) {
     throw reapack_error(String::format("duplicate version '%s'",
       ver->fullName().c_str()));
   }
 
-  m_versions.insert(ver);
-
-  return true;
-}
+  m_versions.insert(it, ver);
+  m_versionMap.insert({ver->name().toString(), ver});
 
-const Version *Package::version(const size_t index) const
-{
-  auto it = m_versions.begin();
-  advance(it, index);
+  if(ver->name().isStable() &&
+      (!m_lastStable || m_lastStable->name() < ver->name()))
+    m_lastStable = ver;
 
-  return *it;
+  return true;
 }
 
 const Version *Package::lastVersion(const bool pres, const VersionName &from) const
@@ -137,23 +140,27 @@ const Version *Package::lastVersion(const bool pres, const VersionName &from) co
   if(m_versions.empty())
     return nullptr;
 
-  for(const Version *ver : m_versions | boost::adaptors::reversed) {
-    if(ver->name() < from)
-      break;
-    else if(ver->name().isStable() || pres)
-      return ver;
-  }
+  const Version *latest = pres ? m_versions.back() : m_lastStable;
 
-  return from.isStable() ? nullptr : *m_versions.rbegin();
+  if(latest && latest->name() >= from)
+    return latest;
+
+  return from.isStable() ? nullptr : m_versions.back();
 }
 
 const Version *Package::findVersion(const VersionName &ver) const
 {
-  const auto &it = find_if(m_versions.begin(), m_versions.end(),
-    [=] (const Version *cur) { return cur->name() == ver; });
+  const auto &match = m_versionMap.find(ver.toString());
 
-  if(it == m_versions.end())
-    return nullptr;
-  else
+  if(match != m_versionMap.end())
+    return match->second;
+
+  // fallback for equivalent names spelled differently (eg. 1.0 and 1.0.0)
+  const auto &it = lower_bound(m_versions.begin(), m_versions.end(), ver,
+    [](const Version *l, const VersionName &r) { return l->name() < r; });
+
+  if(it != m_versions.end() && (*it)->name() == ver)
     return *it;
+  else
+    return nullptr;
 }
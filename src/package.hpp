@@ -21,6 +21,8 @@
 #include "metadata.hpp"
 #include "version.hpp"
 
+#include <unordered_map>
+
 class Category;
 
 class Package {
@@ -62,26 +64,20 @@ public:
 
   bool addVersion(const Version *ver);
   const auto &versions() const { return m_versions; }
-  const Version *version(size_t index) const;
+  const Version *version(size_t index) const { return m_versions[index]; }
   const Version *lastVersion(bool pres = true, const VersionName &from = {}) const;
   const Version *findVersion(const VersionName &) const;
 
 private:
-  class CompareVersion {
-  public:
-    bool operator()(const Version *l, const Version *r) const
-    {
-      return l->name() < r->name();
-    }
-  };
-
   const Category *m_category;
 
   Type m_type;
   std::string m_name;
   std::string m_desc;
   Metadata m_metadata;
-  std::set<const Version *, CompareVersion> m_versions;
+  std::vector<const Version *> m_versions; // sorted by version name
+  std::unordered_map<std::string, const Version *> m_versionMap;
+  const Version *m_lastStable;
 
 };
 
@@ -18,8 +18,7 @@
 #include "path.hpp"
 
 #include <algorithm>
-#include <boost/range/adaptor/reversed.hpp>
-#include <vector>
+#include <cstring>
 
 static constexpr char UNIX_SEPARATOR = '/';
 
@@ -30,8 +29,8 @@ static constexpr char NATIVE_SEPARATOR = UNIX_SEPARATOR;
 static constexpr char NATIVE_SEPARATOR = '\\';
 #endif
 
-static constexpr const char *DOT = ".";
-static constexpr const char *DOTDOT = "..";
+static constexpr std::string_view DOT = ".";
+static constexpr std::string_view DOTDOT = "..";
 
 using namespace std;
 
@@ -39,50 +38,43 @@ const Path Path::DATA("ReaPack");
 const Path Path::CACHE = Path::DATA + "cache";
 const Path Path::CONFIG("reapack.ini");
 const Path Path::REGISTRY = Path::DATA + "registry.db";
+const Path Path::JOURNAL = Path::DATA + "journal.txt";
 
 Path Path::s_root;
 
-static vector<string> Split(const string &input, bool *absolute)
+template<typename Callback>
+static void Split(const string_view &input, bool *absolute, const Callback &append)
 {
-  vector<string> list;
-
-  const auto append = [&list, absolute] (const string &part) {
-    if(part.empty() || part == DOT)
-      return;
-
-#ifdef _WIN32
-    if(list.empty() && part.size() == 2 && isalpha(part[0]) && part[1] == ':')
-      *absolute = true;
-#else
-    (void)absolute;
-#endif
-
-    list.push_back(part);
-  };
-
+  [[maybe_unused]] bool first = true;
   size_t last = 0, size = input.size();
 
   while(last < size) {
-    const size_t pos = input.find_first_of("\\/", last);
+    size_t pos = input.find_first_of("\\/", last);
 
-    if(pos == string::npos) {
-      append(input.substr(last));
-      break;
-    }
-    else if(last + pos == 0) {
+    if(pos == 0) {
 #ifndef _WIN32
       *absolute = true;
 #endif
       last++;
       continue;
     }
+    else if(pos == string_view::npos)
+      pos = size;
 
-    append(input.substr(last, pos - last));
-
+    const string_view &part = input.substr(last, pos - last);
     last = pos + 1;
-  }
 
-  return list;
+    if(part.empty() || part == DOT)
+      continue;
+
+#ifdef _WIN32
+    if(first && part.size() == 2 && isalpha(part[0]) && part[1] == ':')
+      *absolute = true;
+#endif
+
+    first = false;
+    append(part);
+  }
 }
 
 Path::Path(const string &path) : m_absolute(false)
@@ -96,32 +88,48 @@ void Path::append(const string &input, const bool traversal)
     return;
 
   bool absolute = false;
-  const auto &parts = Split(input, &absolute);
+  const bool wasEmpty = empty();
 
-  if(m_parts.empty() && absolute)
-    m_absolute = true;
+  m_buffer.reserve(m_buffer.size() + input.size() + 1);
 
-  for(const string &part : parts) {
+  Split(input, &absolute, [&](const string_view &part) {
     if(part == DOTDOT) {
       if(traversal)
         removeLast();
     }
     else
-      m_parts.push_back(part);
-  }
+      push(part);
+  });
+
+  if(wasEmpty && absolute)
+    m_absolute = true;
 }
 
 void Path::append(const Path &o)
 {
-  if(m_parts.empty() && o.absolute())
+  if(empty() && o.absolute())
     m_absolute = true;
 
-  m_parts.insert(m_parts.end(), o.m_parts.begin(), o.m_parts.end());
+  if(o.empty())
+    return;
+
+  if(!empty())
+    m_buffer += SEPARATOR;
+
+  m_buffer += o.m_buffer;
+}
+
+void Path::push(const string_view part)
+{
+  if(!empty())
+    m_buffer += SEPARATOR;
+
+  m_buffer += part;
 }
 
 void Path::clear()
 {
-  m_parts.clear();
+  m_buffer.clear();
 }
 
 void Path::remove(const size_t pos, size_t count)
@@ -131,13 +139,16 @@ void Path::remove(const size_t pos, size_t count)
   else if(pos + count > size())
     count = size() - pos;
 
-  auto begin = m_parts.begin();
-  advance(begin, pos);
+  if(count > 0) {
+    size_t begin = offset(pos), end = offset(pos + count);
 
-  auto end = begin;
-  advance(end, count);
+    // offset() points after the separator following the removed segments,
+    // remove the preceding separator instead when erasing up to the end
+    if(end == m_buffer.size() && begin > 0)
+      --begin;
 
-  m_parts.erase(begin, end);
+    m_buffer.erase(begin, end - begin);
+  }
 
   if(!pos && m_absolute)
     m_absolute = false;
@@ -145,8 +156,11 @@ void Path::remove(const size_t pos, size_t count)
 
 void Path::removeLast()
 {
-  if(!empty())
-    m_parts.pop_back();
+  if(empty())
+    return;
+
+  const size_t pos = m_buffer.rfind(SEPARATOR);
+  m_buffer.resize(pos == string::npos ? 0 : pos);
 }
 
 string Path::front() const
@@ -154,7 +168,7 @@ string Path::front() const
   if(empty())
     return {};
 
-  return m_parts.front();
+  return string(at(0));
 }
 
 string Path::basename() const
@@ -162,16 +176,23 @@ string Path::basename() const
   if(empty())
     return {};
 
-  return m_parts.back();
+  const size_t pos = m_buffer.rfind(SEPARATOR);
+  return m_buffer.substr(pos == string::npos ? 0 : pos + 1);
 }
 
 Path Path::dirname() const
 {
+  Path dir;
+
   if(empty())
-    return {};
+    return dir;
+
+  const size_t pos = m_buffer.rfind(SEPARATOR);
+  if(pos != string::npos)
+    dir.m_buffer.assign(m_buffer, 0, pos);
+
+  dir.m_absolute = m_absolute;
 
-  Path dir(*this);
-  dir.removeLast();
   return dir;
 }
 
@@ -186,17 +207,14 @@ string Path::join(const bool nativeSeparator) const
 #endif
 
   string path;
+  path.reserve(m_buffer.size() + 1);
 
-  for(const string &part : m_parts) {
-    if(!path.empty() || absoluteSlash)
-      path += sep;
-
-    path += part;
-  }
-
-  if(m_parts.empty() && absoluteSlash)
+  if(absoluteSlash)
     path += sep;
 
+  path += m_buffer;
+  std::replace(path.begin() + absoluteSlash, path.end(), SEPARATOR, sep);
+
 #ifdef _WIN32
   if(m_absolute && path.size() > MAX_PATH)
     path.insert(0, "\\\\?\\");
@@ -210,12 +228,10 @@ bool Path::startsWith(const Path &o) const
   if(size() < o.size() || absolute() != o.absolute())
     return false;
 
-  for(size_t i = 0; i < o.size(); i++) {
-    if(o[i] != at(i))
-      return false;
-  }
+  const size_t len = o.m_buffer.size();
 
-  return true;
+  return m_buffer.compare(0, len, o.m_buffer) == 0 &&
+    (o.empty() || m_buffer.size() == len || m_buffer[len] == SEPARATOR);
 }
 
 Path Path::prependRoot() const
@@ -233,9 +249,20 @@ Path Path::removeRoot() const
   return copy;
 }
 
+auto Path::begin() const -> const_iterator
+{
+  return {m_buffer.data(), m_buffer.data() + m_buffer.size()};
+}
+
+auto Path::end() const -> const_iterator
+{
+  const char *end = m_buffer.data() + m_buffer.size();
+  return {end, end};
+}
+
 bool Path::operator==(const Path &o) const
 {
-  return m_absolute == o.absolute() && m_parts == o.m_parts;
+  return m_absolute == o.absolute() && m_buffer == o.m_buffer;
 }
 
 bool Path::operator!=(const Path &o) const
@@ -245,7 +272,7 @@ bool Path::operator!=(const Path &o) const
 
 bool Path::operator<(const Path &o) const
 {
-  return m_parts < o.m_parts;
+  return m_buffer < o.m_buffer;
 }
 
 Path Path::operator+(const string &part) const
@@ -258,7 +285,9 @@ Path Path::operator+(const string &part) const
 
 Path Path::operator+(const Path &o) const
 {
-  Path path(*this);
+  Path path;
+  path.m_buffer.reserve(m_buffer.size() + o.m_buffer.size() + 1);
+  path.append(*this);
   path.append(o);
 
   return path;
@@ -276,24 +305,76 @@ const Path &Path::operator+=(const Path &o)
   return *this;
 }
 
-const string &Path::at(const size_t index) const
+size_t Path::size() const
+{
+  if(empty())
+    return 0;
+
+  return count(m_buffer.begin(), m_buffer.end(), SEPARATOR) + 1;
+}
+
+size_t Path::offset(const size_t index) const
+{
+  size_t pos = 0;
+
+  for(size_t i = 0; i < index; ++i) {
+    pos = m_buffer.find(SEPARATOR, pos);
+
+    if(pos == string::npos)
+      return m_buffer.size();
+
+    ++pos;
+  }
+
+  return pos;
+}
+
+string_view Path::at(const size_t index) const
 {
-  auto it = m_parts.begin();
-  advance(it, index);
+  const size_t begin = offset(index);
+  const size_t end = m_buffer.find(SEPARATOR, begin);
 
-  return *it;
+  return string_view(m_buffer).substr(begin,
+    end == string::npos ? string::npos : end - begin);
 }
 
-string &Path::operator[](const size_t index)
+void Path::replace(const size_t index, const string_view value)
 {
-  return const_cast<string &>(at(index));
+  const size_t begin = offset(index);
+  m_buffer.replace(begin, at(index).size(), value);
 }
 
-const string &Path::operator[](const size_t index) const
+auto Path::operator[](const size_t index) -> Segment
+{
+  return {this, index};
+}
+
+string_view Path::operator[](const size_t index) const
 {
   return at(index);
 }
 
+auto Path::Segment::operator+=(const string_view value) -> Segment &
+{
+  const size_t end = m_path->offset(m_index) + m_path->at(m_index).size();
+  m_path->m_buffer.insert(end, value);
+  return *this;
+}
+
+Path::const_iterator::const_iterator(const char *pos, const char *end)
+  : m_pos(pos), m_end(end)
+{
+  const void *sep = memchr(m_pos, SEPARATOR, m_end - m_pos);
+  m_len = (sep ? static_cast<const char *>(sep) : m_end) - m_pos;
+}
+
+auto Path::const_iterator::operator++() -> const_iterator &
+{
+  m_pos = std::min(m_pos + m_len + 1, m_end);
+  *this = const_iterator(m_pos, m_end);
+  return *this;
+}
+
 UseRootPath::UseRootPath(const Path &path)
   : m_backup(move(Path::s_root))
 {
@@ -18,17 +18,23 @@
 #ifndef REAPACK_PATH_HPP
 #define REAPACK_PATH_HPP
 
-#include <list>
+#include <functional>
+#include <iterator>
 #include <string>
+#include <string_view>
 
 class UseRootPath;
 
 class Path {
 public:
+  class Segment;
+  class const_iterator;
+
   static const Path DATA;
   static const Path CACHE;
   static const Path CONFIG;
   static const Path REGISTRY;
+  static const Path JOURNAL;
 
   static const Path &root() { return s_root; }
 
@@ -40,8 +46,8 @@ public:
   void removeLast();
   void clear();
 
-  bool empty() const { return m_parts.empty(); }
-  size_t size() const { return m_parts.size(); }
+  bool empty() const { return m_buffer.empty(); }
+  size_t size() const;
   bool absolute() const { return m_absolute; }
 
   Path dirname() const;
@@ -53,8 +59,8 @@ public:
   Path prependRoot() const;
   Path removeRoot() const;
 
-  std::list<std::string>::const_iterator begin() const { return m_parts.begin(); }
-  std::list<std::string>::const_iterator end() const { return m_parts.end(); }
+  const_iterator begin() const;
+  const_iterator end() const;
 
   bool operator==(const Path &) const;
   bool operator!=(const Path &) const;
@@ -63,24 +69,84 @@ public:
   Path operator+(const Path &) const;
   const Path &operator+=(const std::string &);
   const Path &operator+=(const Path &);
-  std::string &operator[](size_t);
-  const std::string &operator[](size_t) const;
+  Segment operator[](size_t);
+  std::string_view operator[](size_t) const;
 
 private:
   static Path s_root;
   friend UseRootPath;
+  friend std::hash<Path>;
+
+  // Segments are stored in a single buffer, separated by a null character.
+  // Null sorts before any other character so comparing the buffers gives
+  // the same ordering as comparing the segments one by one.
+  static constexpr char SEPARATOR = '\0';
 
-  const std::string &at(size_t) const;
+  void push(std::string_view part);
+  std::string_view at(size_t) const;
+  size_t offset(size_t index) const;
+  void replace(size_t index, std::string_view);
 
-  std::list<std::string> m_parts;
+  std::string m_buffer;
   bool m_absolute;
 };
 
+class Path::Segment {
+public:
+  Segment &operator=(std::string_view value)
+    { m_path->replace(m_index, value); return *this; }
+  Segment &operator+=(std::string_view);
+
+  operator std::string_view() const { return m_path->at(m_index); }
+  bool operator==(std::string_view o) const { return m_path->at(m_index) == o; }
+  bool operator!=(std::string_view o) const { return m_path->at(m_index) != o; }
+
+private:
+  friend Path;
+  Segment(Path *path, size_t index) : m_path(path), m_index(index) {}
+
+  Path *m_path;
+  size_t m_index;
+};
+
+class Path::const_iterator {
+public:
+  typedef std::forward_iterator_tag iterator_category;
+  typedef std::string_view value_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef const std::string_view *pointer;
+  typedef std::string_view reference;
+
+  std::string_view operator*() const { return {m_pos, m_len}; }
+  const_iterator &operator++();
+  const_iterator operator++(int) { const_iterator it(*this); ++*this; return it; }
+
+  bool operator==(const const_iterator &o) const { return m_pos == o.m_pos; }
+  bool operator!=(const const_iterator &o) const { return m_pos != o.m_pos; }
+
+private:
+  friend Path;
+  const_iterator(const char *pos, const char *end);
+
+  const char *m_pos;
+  const char *m_end;
+  size_t m_len;
+};
+
 inline std::ostream &operator<<(std::ostream &os, const Path &p)
 {
   return os << p.join();
 };
 
+namespace std {
+  template<> struct hash<Path> {
+    std::size_t operator()(const Path &p) const
+    {
+      return std::hash<std::string>()(p.m_buffer) ^ p.m_absolute;
+    }
+  };
+}
+
 class UseRootPath {
 public:
   UseRootPath(const Path &);
@@ -25,6 +25,12 @@
 
 using namespace std;
 
+enum Timers { TIMER_SHOW = 1, TIMER_UPDATE };
+
+// tasks can start and finish by the thousands per second:
+// refresh the dialog at most this often instead of after each of them
+static constexpr int UPDATE_INTERVAL = 50;
+
 Progress::Progress(ThreadPool *pool)
   : Dialog(IDD_PROGRESS_DIALOG),
     m_pool(pool), m_label(nullptr), m_progress(nullptr),
@@ -33,6 +39,13 @@ Progress::Progress(ThreadPool *pool)
   m_pool->onPush >> bind(&Progress::addTask, this, placeholders::_1);
 }
 
+Progress::~Progress()
+{
+  // Also drops the transaction's handler. This is fine because the
+  // transaction is finished when its progress dialog is closed.
+  m_pool->onPush.reset();
+}
+
 void Progress::onInit()
 {
   Dialog::onInit();
@@ -58,34 +71,47 @@ void Progress::onCommand(const int id, int)
 
 void Progress::onTimer(const int id)
 {
+  switch(id) {
+  case TIMER_SHOW:
 #ifdef _WIN32
-  if(!IsWindowEnabled(handle()))
-    return;
+    if(!IsWindowEnabled(handle()))
+      return;
 #endif
 
-  show();
+    show();
+    break;
+  case TIMER_UPDATE:
+    updateProgress();
+    break;
+  }
+
   stopTimer(id);
 }
 
 void Progress::addTask(ThreadTask *task)
 {
   m_total++;
-  updateProgress();
+  scheduleUpdate();
 
   if(!isVisible())
-    startTimer(100);
+    startTimer(100, TIMER_SHOW, false);
 
   task->onStartAsync >> [=] {
     m_current = task->summary();
-    updateProgress();
+    scheduleUpdate();
   };
 
   task->onFinishAsync >> [=] {
     m_done++;
-    updateProgress();
+    scheduleUpdate();
   };
 }
 
+void Progress::scheduleUpdate()
+{
+  startTimer(UPDATE_INTERVAL, TIMER_UPDATE, false);
+}
+
 void Progress::updateProgress()
 {
   Win32::setWindowText(m_label, String::format(m_current.c_str(),
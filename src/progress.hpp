@@ -26,6 +26,7 @@ class ThreadTask;
 class Progress : public Dialog {
 public:
   Progress(ThreadPool *);
+  ~Progress();
 
 protected:
   void onInit() override;
@@ -34,6 +35,7 @@ protected:
 
 private:
   void addTask(ThreadTask *);
+  void scheduleUpdate();
   void updateProgress();
 
   ThreadPool *m_pool;
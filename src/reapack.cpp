@@ -28,11 +28,12 @@
 #include "obsquery.hpp"
 #include "progress.hpp"
 #include "report.hpp"
-#include "richedit.hpp"
 #include "transaction.hpp"
 #include "win32.hpp"
 
 #include <cassert>
+#include <cstdio>
+#include <cstdlib>
 
 #include <reaper_plugin_functions.h>
 
@@ -47,9 +48,8 @@ ReaPack *ReaPack::s_instance = nullptr;
 // Removes temporary files that could not be removed by an installation task
 // (eg. extensions dll that were in use by REAPER).
 // Surely there must be a better way...
-static void CleanupTempFiles()
+static void CleanupTempFiles(const Path &path)
 {
-  const Path &path = (Path::DATA + "*.tmp").prependRoot();
   const wstring &pattern = Win32::widen(path.join());
 
   WIN32_FIND_DATA fd = {};
@@ -80,35 +80,65 @@ Path ReaPack::resourcePath()
 }
 
 ReaPack::ReaPack(REAPER_PLUGIN_HINSTANCE instance, HWND mainWindow)
-  : m_instance(instance), m_mainWindow(mainWindow),
+  : m_startTime(chrono::steady_clock::now()),
+    m_instance(instance), m_mainWindow(mainWindow),
     m_useRootPath(resourcePath()), m_config(Path::CONFIG.prependRoot()), m_tx{}
 {
   assert(!s_instance);
   s_instance = this;
 
-  DownloadContext::GlobalInit();
-  RichEdit::Init();
+  traceStartup("configuration loaded");
 
   createDirectories();
   registerSelf();
+  traceStartup("registry updated");
+
   setupActions();
   setupAPI();
+  traceStartup("actions and API registered");
 
   if(m_config.isFirstRun())
     manageRemotes();
 
 #ifdef _WIN32
-  CleanupTempFiles();
+  m_cleanupTempFiles = async(launch::async,
+    CleanupTempFiles, (Path::DATA + "*.tmp").prependRoot());
 #endif
+
+  traceStartup("ready");
 }
 
 ReaPack::~ReaPack()
 {
+  // the workers' download contexts must go before cURL's global state
+  m_threadPool.shutdown();
   DownloadContext::GlobalCleanup();
 
   s_instance = nullptr;
 }
 
+// Set the REAPACK_TRACE_STARTUP environment variable to measure how much
+// of REAPER's startup time is spent loading ReaPack.
+void ReaPack::traceStartup(const char *step) const
+{
+  static const bool enabled = getenv("REAPACK_TRACE_STARTUP") != nullptr;
+
+  if(!enabled)
+    return;
+
+  const chrono::duration<double, milli> elapsed =
+    chrono::steady_clock::now() - m_startTime;
+
+  const string &message =
+    String::format("ReaPack: %s (%.2f ms)\n", step, elapsed.count());
+
+#ifdef _WIN32
+  OutputDebugStringA(message.c_str());
+#else
+  fputs(message.c_str(), stderr);
+#endif
+}
+
 void ReaPack::setupActions()
 {
   m_actions.add("REAPACK_SYNC", "ReaPack: Synchronize packages",
@@ -117,6 +147,12 @@ void ReaPack::setupActions()
   m_actions.add("REAPACK_BROWSE", "ReaPack: Browse packages...",
     std::bind(&ReaPack::browsePackages, this));
 
+  m_actions.add("REAPACK_VERIFY", "ReaPack: Verify installed files",
+    std::bind(&ReaPack::verifyInstallation, this, false));
+
+  m_actions.add("REAPACK_REPAIR", "ReaPack: Repair modified installed files",
+    std::bind(&ReaPack::verifyInstallation, this, true));
+
   m_actions.add("REAPACK_UPLOAD", "ReaPack: Upload packages...",
     std::bind(&ReaPack::uploadPackage, this));
 
@@ -143,6 +179,8 @@ void ReaPack::setupAPI()
   m_api.emplace_back(&API::GetOwner);
   m_api.emplace_back(&API::GetRepositoryInfo);
   m_api.emplace_back(&API::ProcessQueue);
+  m_api.emplace_back(&API::SearchPackages);
+  m_api.emplace_back(&API::VerifyInstallation);
 }
 
 void ReaPack::synchronizeAll()
@@ -165,6 +203,19 @@ void ReaPack::synchronizeAll()
   tx->runTasks();
 }
 
+bool ReaPack::verifyInstallation(const bool repair)
+{
+  Transaction *tx = setupTransaction();
+
+  if(!tx)
+    return false;
+
+  tx->verify(repair);
+  tx->runTasks();
+
+  return true;
+}
+
 void ReaPack::addSetRemote(const Remote &remote)
 {
   if(remote.isEnabled() && remote.autoInstall(m_config.install.autoInstall)) {
@@ -185,10 +236,11 @@ void ReaPack::uninstall(const Remote &remote)
     return;
 
   assert(m_tx);
-  m_tx->uninstall(remote);
+  Transaction *tx = m_tx;
+  tx->uninstall(remote);
 
-  m_tx->onFinish >> [=] {
-    if(!m_tx->isCancelled())
+  tx->onFinish >> [=] {
+    if(!tx->isCancelled())
       config()->remotes.remove(remote);
   };
 }
@@ -278,11 +330,21 @@ Transaction *ReaPack::setupTransaction()
   if(m_progress && m_progress->isVisible())
     m_progress->setFocus();
 
-  if(m_tx)
+  // new requests join the running transaction's pipeline, or a follow-up
+  // transaction if it is already finishing (eg. API calls from its handlers)
+  if(m_tx && !m_tx->isFinished())
     return m_tx;
 
+#ifdef _WIN32
+  // don't let the startup cleanup delete the new transaction's temporary files
+  if(m_cleanupTempFiles.valid())
+    m_cleanupTempFiles.wait();
+#endif
+
+  Transaction *tx;
+
   try {
-    m_tx = new Transaction;
+    tx = new Transaction(&m_threadPool);
   }
   catch(const reapack_error &e) {
     Win32::messageBox(m_mainWindow, String::format(
@@ -292,21 +354,23 @@ Transaction *ReaPack::setupTransaction()
     return nullptr;
   }
 
+  m_tx = tx;
+
   assert(!m_progress);
-  m_progress = Dialog::Create<Progress>(m_instance, m_mainWindow, m_tx->threadPool());
+  m_progress = Dialog::Create<Progress>(m_instance, m_mainWindow, tx->threadPool());
 
-  m_tx->onFinish >> [=] {
+  tx->onFinish >> [=] {
     m_progress.reset();
 
-    if(!m_tx->isCancelled() && !m_tx->receipt()->empty()) {
+    if(!tx->isCancelled() && !tx->receipt()->empty()) {
       LockDialog managerLock(m_manager.get());
       LockDialog browserLock(m_browser.get());
 
-      Dialog::Show<Report>(m_instance, m_mainWindow, m_tx->receipt());
+      Dialog::Show<Report>(m_instance, m_mainWindow, tx->receipt());
     }
   };
 
-  m_tx->setObsoleteHandler([=] (vector<Registry::Entry> &entries) {
+  tx->setObsoleteHandler([=] (vector<Registry::Entry> &entries) {
     LockDialog aboutLock(m_about.get());
     LockDialog browserLock(m_browser.get());
     LockDialog managerLock(m_manager.get());
@@ -316,17 +380,24 @@ Transaction *ReaPack::setupTransaction()
       &entries, &config()->install.promptObsolete) == IDOK;
   });
 
-  m_tx->setCleanupHandler(bind(&ReaPack::teardownTransaction, this));
+  tx->setCleanupHandler(bind(&ReaPack::teardownTransaction, this, tx));
 
-  return m_tx;
+  return tx;
 }
 
-void ReaPack::teardownTransaction()
+void ReaPack::teardownTransaction(Transaction *tx)
 {
-  const bool needRefresh = m_tx->receipt()->test(Receipt::RefreshBrowser);
+  const bool needRefresh = tx->receipt()->test(Receipt::RefreshBrowser);
+
+  delete tx;
 
-  delete m_tx;
-  m_tx = nullptr;
+  if(m_tx == tx) {
+    m_tx = nullptr;
+
+    // No follow-up transaction: stop the idle workers now. This lets their
+    // download contexts and connections go away (see WorkerThread::run).
+    m_threadPool.shutdown();
+  }
 
   // Update the browser only after the transaction is deleted because
   // it must be able to start a new one to load the indexes
@@ -336,7 +407,7 @@ void ReaPack::teardownTransaction()
 
 void ReaPack::commitConfig(bool refresh)
 {
-  if(m_tx) {
+  if(m_tx && !m_tx->isFinished()) {
     if(refresh) {
       m_tx->receipt()->setIndexChanged(); // force browser refresh
       m_tx->onFinish >> bind(&ReaPack::refreshManager, this);
@@ -23,8 +23,12 @@
 #include "browser.hpp"
 #include "browser_entry.hpp"
 #include "config.hpp"
+#include "indexcache.hpp"
 #include "path.hpp"
+#include "thread.hpp"
 
+#include <chrono>
+#include <future>
 #include <list>
 
 #include <reaper_plugin.h>
@@ -52,6 +56,7 @@ public:
   ActionList *actions() { return &m_actions; }
 
   void synchronizeAll();
+  bool verifyInstallation(bool repair);
   void uninstall(const Remote &);
 
   void uploadPackage();
@@ -70,6 +75,7 @@ public:
   Transaction *setupTransaction();
   void commitConfig(bool refresh = true);
   Config *config() { return &m_config; }
+  IndexCache *indexCache() { return &m_indexCache; }
 
 private:
   static ReaPack *s_instance;
@@ -78,21 +84,29 @@ private:
   void registerSelf();
   void setupActions();
   void setupAPI();
-  void teardownTransaction();
+  void teardownTransaction(Transaction *);
+  void traceStartup(const char *step) const;
 
+  std::chrono::steady_clock::time_point m_startTime;
   REAPER_PLUGIN_HINSTANCE m_instance;
   HWND m_mainWindow;
 
   UseRootPath m_useRootPath;
   Config m_config;
+  IndexCache m_indexCache;
   ActionList m_actions;
   std::list<APIDef> m_api;
 
+  ThreadPool m_threadPool;
   Transaction *m_tx;
   std::unique_ptr<About> m_about;
   std::unique_ptr<Browser> m_browser;
   std::unique_ptr<Manager> m_manager;
   std::unique_ptr<Progress> m_progress;
+
+#ifdef _WIN32
+  std::future<void> m_cleanupTempFiles;
+#endif
 };
 
 #endif
@@ -36,7 +36,8 @@ bool Receipt::empty() const
     m_installs.empty() &&
     m_removals.empty() &&
     m_exports.empty() &&
-    m_errors.empty();
+    m_errors.empty() &&
+    !test(VerifiedFlag);
 }
 
 void Receipt::addInstall(const Version *ver, const Registry::Entry &entry)
@@ -60,6 +61,12 @@ void Receipt::addExport(const Path &path)
   m_flags |= ExportedFlag;
 }
 
+void Receipt::addMismatch(const Path &path, const bool missing)
+{
+  m_mismatches.insert(path.join() + (missing ? " [missing]" : " [modified]"));
+  m_flags |= VerifiedFlag;
+}
+
 void Receipt::addError(const ErrorInfo &err)
 {
   m_errors.push_back(err);
@@ -81,6 +88,11 @@ ReceiptPage Receipt::exportedPage() const
   return {m_exports, "Exported"};
 }
 
+ReceiptPage Receipt::mismatchPage() const
+{
+  return {m_mismatches, "Modified"};
+}
+
 ReceiptPage Receipt::errorPage() const
 {
   return {m_errors, "Error", "Errors"};
@@ -45,6 +45,7 @@ public:
     InstalledFlag      = 1<<4,
     RemovedFlag        = 1<<5,
     ExportedFlag       = 1<<6,
+    VerifiedFlag       = 1<<7,
 
     InstalledOrRemoved = InstalledFlag | RemovedFlag,
     RefreshBrowser = IndexChangedFlag | PackageChangedFlag | InstalledOrRemoved,
@@ -62,10 +63,13 @@ public:
   void addRemoval(const Path &p);
   void addExport(const Path &p);
   void addError(const ErrorInfo &);
+  void setVerified() { m_flags |= VerifiedFlag; }
+  void addMismatch(const Path &, bool missing);
 
   ReceiptPage installedPage() const;
   ReceiptPage removedPage() const;
   ReceiptPage exportedPage() const;
+  ReceiptPage mismatchPage() const;
   ReceiptPage errorPage() const;
 
 private:
@@ -74,6 +78,7 @@ private:
   std::multiset<InstallTicket> m_installs;
   std::set<Path> m_removals;
   std::set<Path> m_exports;
+  std::set<std::string> m_mismatches;
   std::vector<ErrorInfo> m_errors;
 };
 
@@ -56,6 +56,10 @@ Registry::Registry(const Path &path)
     "SELECT id, remote, category, package, desc, type, version, author, pinned "
     "FROM entries WHERE remote = ?"
   );
+  m_everyEntry = m_db.prepare(
+    "SELECT id, remote, category, package, desc, type, version, author, pinned "
+    "FROM entries ORDER BY remote"
+  );
   m_forgetEntry = m_db.prepare("DELETE FROM entries WHERE id = ?");
 
   // file queries
@@ -64,9 +68,14 @@ Registry::Registry(const Path &path)
     "FROM entries e JOIN files f ON f.entry = e.id WHERE f.path = ? LIMIT 1"
   );
   m_getFiles = m_db.prepare(
-    "SELECT path, main, type FROM files WHERE entry = ? ORDER BY path"
+    "SELECT path, main, type, checksum, size FROM files WHERE entry = ? ORDER BY path"
+  );
+  m_insertFile = m_db.prepare(
+    "INSERT INTO files(entry, path, main, type) VALUES(?, ?, ?, ?)"
+  );
+  m_setChecksum = m_db.prepare(
+    "UPDATE files SET checksum = ?, size = ? WHERE path = ?"
   );
-  m_insertFile = m_db.prepare("INSERT INTO files VALUES(NULL, ?, ?, ?, ?)");
   m_clearFiles = m_db.prepare(
     "DELETE FROM files WHERE entry = ("
     "  SELECT id FROM entries WHERE remote = ? AND category = ? AND package = ?"
@@ -80,7 +89,7 @@ Registry::Registry(const Path &path)
 
 void Registry::migrate()
 {
-  const Database::Version version{0, 5};
+  const Database::Version version{0, 6};
   const Database::Version &current = m_db.version();
 
   if(!current) {
@@ -105,6 +114,8 @@ void Registry::migrate()
       "  path TEXT UNIQUE NOT NULL,"
       "  main INTEGER NOT NULL,"
       "  type INTEGER NOT NULL,"
+      "  checksum TEXT NOT NULL DEFAULT '',"
+      "  size INTEGER NOT NULL DEFAULT 0,"
       "  FOREIGN KEY(entry) REFERENCES entries(id)"
       ");"
     );
@@ -137,6 +148,12 @@ void Registry::migrate()
       [[fallthrough]];
     case 4:
       convertImplicitSections();
+      [[fallthrough]];
+    case 5:
+      m_db.exec(
+        "ALTER TABLE files ADD COLUMN checksum TEXT NOT NULL DEFAULT '';"
+        "ALTER TABLE files ADD COLUMN size INTEGER NOT NULL DEFAULT 0;"
+      );
       break;
     }
 
@@ -226,6 +243,15 @@ void Registry::setPinned(const Entry &entry, const bool pinned)
   m_setPinned->exec();
 }
 
+void Registry::setChecksum(const Path &path, const string &checksum,
+  const uint64_t size)
+{
+  m_setChecksum->bind(1, checksum);
+  m_setChecksum->bind(2, static_cast<int64_t>(size));
+  m_setChecksum->bind(3, path.join(false));
+  m_setChecksum->exec();
+}
+
 auto Registry::getEntry(const Package *pkg) const -> Entry
 {
   Entry entry{};
@@ -261,6 +287,21 @@ auto Registry::getEntries(const string &remoteName) const -> vector<Entry>
   return list;
 }
 
+auto Registry::getEntries() const -> vector<Entry>
+{
+  vector<Registry::Entry> list;
+
+  m_everyEntry->exec([&] {
+    Entry entry{};
+    fillEntry(m_everyEntry, &entry);
+    list.push_back(entry);
+
+    return true;
+  });
+
+  return list;
+}
+
 auto Registry::getFiles(const Entry &entry) const -> vector<File>
 {
   if(!entry) // skip processing for new packages
@@ -276,6 +317,8 @@ auto Registry::getFiles(const Entry &entry) const -> vector<File>
       m_getFiles->stringColumn(col++),
       static_cast<int>(m_getFiles->intColumn(col++)),
       static_cast<Package::Type>(m_getFiles->intColumn(col++)),
+      m_getFiles->stringColumn(col++),
+      static_cast<uint64_t>(m_getFiles->intColumn(col++)),
     };
 
     if(!file.type) // < v1.0rc2
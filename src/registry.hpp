@@ -49,6 +49,8 @@ public:
     Path path;
     int sections;
     Package::Type type;
+    std::string checksum; // empty if installed by an older version
+    uint64_t size;
 
     bool operator<(const File &o) const { return path < o.path; }
   };
@@ -58,10 +60,12 @@ public:
   Entry getEntry(const Package *) const;
   Entry getOwner(const Path &) const;
   std::vector<Entry> getEntries(const std::string &) const;
+  std::vector<Entry> getEntries() const; // from every repository
   std::vector<File> getFiles(const Entry &) const;
   std::vector<File> getMainFiles(const Entry &) const;
   Entry push(const Version *, std::vector<Path> *conflicts = nullptr);
   void setPinned(const Entry &, bool pinned);
+  void setChecksum(const Path &, const std::string &checksum, uint64_t size);
   void forget(const Entry &);
 
   void savepoint() { m_db.savepoint(); }
@@ -79,11 +83,13 @@ private:
   Statement *m_setPinned;
   Statement *m_findEntry;
   Statement *m_allEntries;
+  Statement *m_everyEntry;
   Statement *m_forgetEntry;
   Statement *m_getOwner;
 
   Statement *m_getFiles;
   Statement *m_insertFile;
+  Statement *m_setChecksum;
   Statement *m_clearFiles;
   Statement *m_forgetFiles;
 };
@@ -42,6 +42,7 @@ void Report::onInit()
     m_receipt->installedPage(),
     m_receipt->removedPage(),
     m_receipt->exportedPage(),
+    m_receipt->mismatchPage(),
     m_receipt->errorPage(),
   };
 
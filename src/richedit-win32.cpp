@@ -46,7 +46,10 @@ static void HandleLink(ENLINK *info, HWND handle)
 
 void RichEdit::Init()
 {
-  LoadLibrary(L"Msftedit.dll");
+  static bool loaded = false;
+
+  if(!loaded)
+    loaded = LoadLibrary(L"Msftedit.dll") != nullptr;
 }
 
 RichEdit::RichEdit(HWND handle)
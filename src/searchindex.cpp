@@ -0,0 +1,245 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2019  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "searchindex.hpp"
+
+#include "index.hpp"
+#include "string.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+using namespace std;
+
+static uint32_t trigramAt(const char *text)
+{
+  return static_cast<unsigned char>(text[0]) << 16 |
+    static_cast<unsigned char>(text[1]) << 8 | static_cast<unsigned char>(text[2]);
+}
+
+SearchIndex::SearchIndex(const Index &index)
+  : m_indexName(String::fold(index.name()))
+{
+  const auto &packages = index.packages();
+  m_docs.reserve(packages.size());
+
+  vector<uint64_t> pairs; // trigram << 32 | document, sorted below
+  vector<uint32_t> trigrams;
+
+  for(DocId doc = 0; doc < packages.size(); ++doc) {
+    const Package *pkg = packages[doc];
+    const size_t offset = m_text.size();
+
+    vector<string> values{pkg->displayName(), pkg->name(), pkg->category()->name()};
+
+    for(const Version *ver : pkg->versions()) {
+      const string &author = ver->displayAuthor();
+      if(find(values.begin() + Author, values.end(), author) == values.end())
+        values.push_back(author);
+    }
+
+    trigrams.clear();
+
+    for(const string &value : values) {
+      if(m_text.size() > offset)
+        m_text += '\0';
+
+      const string &folded = String::fold(value);
+      for(size_t i = 0; i + 3 <= folded.size(); ++i)
+        trigrams.push_back(trigramAt(&folded[i]));
+
+      m_text += folded;
+    }
+
+    m_docs.push_back({pkg, offset, m_text.size() - offset});
+
+    sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+    for(const uint32_t trigram : trigrams)
+      pairs.push_back(static_cast<uint64_t>(trigram) << 32 | doc);
+  }
+
+  sort(pairs.begin(), pairs.end());
+  m_postings.reserve(pairs.size());
+
+  for(const uint64_t pair : pairs) {
+    const uint32_t trigram = static_cast<uint32_t>(pair >> 32);
+
+    if(m_trigrams.empty() || m_trigrams.back() != trigram) {
+      m_trigrams.push_back(trigram);
+      m_offsets.push_back(static_cast<uint32_t>(m_postings.size()));
+    }
+
+    m_postings.push_back(static_cast<DocId>(pair));
+  }
+
+  m_offsets.push_back(static_cast<uint32_t>(m_postings.size()));
+}
+
+bool SearchIndex::inRepository(const string &term) const
+{
+  return m_indexName.find(term) != string::npos;
+}
+
+auto SearchIndex::postings(const uint32_t trigram, size_t *count) const
+  -> const DocId *
+{
+  const auto &it = lower_bound(m_trigrams.begin(), m_trigrams.end(), trigram);
+
+  if(it == m_trigrams.end() || *it != trigram)
+    return nullptr;
+
+  const size_t i = it - m_trigrams.begin();
+  *count = m_offsets[i + 1] - m_offsets[i];
+  return &m_postings[m_offsets[i]];
+}
+
+auto SearchIndex::candidates(const vector<string> &terms) const -> vector<DocId>
+{
+  vector<DocId> result, intersection;
+  bool everything = true;
+
+  for(const string &term : terms) {
+    if(term.size() < 3 || inRepository(term))
+      continue;
+
+    vector<pair<const DocId *, size_t>> lists;
+
+    for(size_t i = 0; i + 3 <= term.size(); ++i) {
+      size_t count;
+      const DocId *list = postings(trigramAt(&term[i]), &count);
+
+      if(!list)
+        return {};
+
+      lists.push_back({list, count});
+    }
+
+    // intersect the shortest lists first to keep the result small
+    sort(lists.begin(), lists.end(),
+      [](const auto &a, const auto &b) { return a.second < b.second; });
+
+    for(const auto &[list, count] : lists) {
+      if(everything) {
+        result.assign(list, list + count);
+        everything = false;
+        continue;
+      }
+
+      intersection.clear();
+
+      // look up the few remaining documents instead of walking long lists
+      if(result.size() * 16 < count) {
+        copy_if(result.begin(), result.end(), back_inserter(intersection),
+          [&](const DocId doc) { return binary_search(list, list + count, doc); });
+      }
+      else {
+        set_intersection(result.begin(), result.end(),
+          list, list + count, back_inserter(intersection));
+      }
+
+      result.swap(intersection);
+
+      if(result.empty())
+        return result;
+    }
+  }
+
+  if(everything) {
+    result.resize(m_docs.size());
+    iota(result.begin(), result.end(), 0);
+  }
+
+  return result;
+}
+
+int SearchIndex::score(const DocId doc, const vector<string> &terms) const
+{
+  const string_view &docText = text(doc);
+  int total = 0;
+
+  for(const string &term : terms) {
+    int best = inRepository(term) ? 1 : 0;
+    size_t field = DisplayName;
+
+    for(size_t start = 0; start <= docText.size(); ++field) {
+      const size_t end = min(docText.find('\0', start), docText.size());
+      const string_view &value = docText.substr(start, end - start);
+      const size_t pos = value.find(term);
+      start = end + 1;
+
+      if(pos == string_view::npos)
+        continue;
+
+      switch(field) {
+      case DisplayName:
+      case Name:
+        best = max(best, value.size() == term.size() ? 100 : pos == 0 ? 50 : 20);
+        break;
+      case CategoryName:
+        best = max(best, 10);
+        break;
+      default: // Author
+        best = max(best, 5);
+        break;
+      }
+    }
+
+    if(!best)
+      return 0;
+
+    total += best;
+  }
+
+  return total;
+}
+
+auto SearchIndex::search(const string_view query, const size_t limit) const
+  -> vector<Result>
+{
+  vector<string> terms;
+
+  const string &folded = String::fold(query);
+  for(size_t start = 0; start < folded.size();) {
+    const size_t end = min(folded.find_first_of("\x20\t", start), folded.size());
+
+    if(end > start)
+      terms.emplace_back(folded.substr(start, end - start));
+
+    start = end + 1;
+  }
+
+  if(terms.empty())
+    return {};
+
+  vector<Result> results;
+
+  for(const DocId doc : candidates(terms)) {
+    if(const int score = this->score(doc, terms))
+      results.push_back({m_docs[doc].package, score});
+  }
+
+  // equal scores keep the order of the index
+  stable_sort(results.begin(), results.end(),
+    [](const Result &a, const Result &b) { return a.score > b.score; });
+
+  if(limit && results.size() > limit)
+    results.resize(limit);
+
+  return results;
+}
@@ -0,0 +1,79 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2019  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REAPACK_SEARCHINDEX_HPP
+#define REAPACK_SEARCHINDEX_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class Index;
+class Package;
+
+// Trigram inverted index over the searchable text of the packages of a
+// repository index: the display name, name, category and version authors.
+// Built once per loaded Index (see Index::searchIndex).
+class SearchIndex {
+public:
+  typedef uint32_t DocId; // position in Index::packages()
+
+  struct Result {
+    const Package *package;
+    int score;
+  };
+
+  SearchIndex(const Index &);
+  SearchIndex(const SearchIndex &) = delete;
+
+  // Sorted packages whose text may contain every term (case-folded) in one of
+  // its values. Terms too short to be indexed do not restrict the result.
+  std::vector<DocId> candidates(const std::vector<std::string> &terms) const;
+
+  // Packages containing every word of the query, best matches first.
+  std::vector<Result> search(std::string_view query, size_t limit = 0) const;
+
+  size_t size() const { return m_docs.size(); }
+
+private:
+  enum Field { DisplayName, Name, CategoryName, Author };
+
+  struct Document {
+    const Package *package;
+    size_t offset; // in m_text
+    size_t size;
+  };
+
+  std::string_view text(DocId doc) const
+    { return {m_text.data() + m_docs[doc].offset, m_docs[doc].size}; }
+  bool inRepository(const std::string &term) const;
+  const DocId *postings(uint32_t trigram, size_t *count) const;
+  int score(DocId, const std::vector<std::string> &terms) const;
+
+  std::string m_indexName; // case-folded, matches every package
+  std::vector<Document> m_docs;
+  std::string m_text; // case-folded fields, null-separated
+
+  // compressed sparse rows: the documents containing m_trigrams[i] are
+  // m_postings[m_offsets[i]] to m_postings[m_offsets[i + 1]]
+  std::vector<uint32_t> m_trigrams;
+  std::vector<uint32_t> m_offsets;
+  std::vector<DocId> m_postings;
+};
+
+#endif
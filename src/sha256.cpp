@@ -0,0 +1,404 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2019  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sha256.hpp"
+
+#include "cpu.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef REAPACK_CPU_X86
+#  include <immintrin.h>
+#endif
+
+static const uint32_t H0[8] {
+  0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+  0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+alignas(16) static const uint32_t K[64] {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+  0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+  0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+  0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+  0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+  0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+  0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+  0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+  0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static inline uint32_t readBE32(const unsigned char *p)
+{
+  return uint32_t(p[0]) << 24 | uint32_t(p[1]) << 16 |
+         uint32_t(p[2]) << 8  | uint32_t(p[3]);
+}
+
+static inline void writeBE32(unsigned char *p, const uint32_t v)
+{
+  p[0] = static_cast<unsigned char>(v >> 24);
+  p[1] = static_cast<unsigned char>(v >> 16);
+  p[2] = static_cast<unsigned char>(v >> 8);
+  p[3] = static_cast<unsigned char>(v);
+}
+
+static inline uint32_t rotr(const uint32_t x, const int n)
+{
+  return (x >> n) | (x << (32 - n));
+}
+
+static void compressGeneric(uint32_t *state, const unsigned char *blocks, size_t count)
+{
+  for(; count; --count, blocks += 64) {
+    uint32_t w[64];
+
+    for(int t = 0; t < 16; ++t)
+      w[t] = readBE32(blocks + t * 4);
+
+    for(int t = 16; t < 64; ++t) {
+      const uint32_t s0 = rotr(w[t - 15], 7) ^ rotr(w[t - 15], 18) ^ (w[t - 15] >> 3);
+      const uint32_t s1 = rotr(w[t - 2], 17) ^ rotr(w[t - 2], 19) ^ (w[t - 2] >> 10);
+      w[t] = w[t - 16] + s0 + w[t - 7] + s1;
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3],
+             e = state[4], f = state[5], g = state[6], h = state[7];
+
+    for(int t = 0; t < 64; ++t) {
+      const uint32_t s1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+      const uint32_t ch = (e & f) ^ (~e & g);
+      const uint32_t t1 = h + s1 + ch + K[t] + w[t];
+      const uint32_t s0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+      const uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+      const uint32_t t2 = s0 + maj;
+
+      h = g; g = f; f = e; e = d + t1;
+      d = c; c = b; b = a; a = t1 + t2;
+    }
+
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+  }
+}
+
+#ifdef REAPACK_CPU_X86
+CPU_TARGET("sha,sse4.1,ssse3")
+static void compressSHANI(uint32_t *state, const unsigned char *blocks, size_t count)
+{
+  const __m128i byteSwap =
+    _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+  // the SHA instructions work on the ABEF and CDGH halves of the state
+  __m128i tmp = _mm_shuffle_epi32(
+    _mm_loadu_si128(reinterpret_cast<const __m128i *>(&state[0])), 0xB1); // CDAB
+  __m128i state1 = _mm_shuffle_epi32(
+    _mm_loadu_si128(reinterpret_cast<const __m128i *>(&state[4])), 0x1B); // EFGH
+  __m128i state0 = _mm_alignr_epi8(tmp, state1, 8); // ABEF
+  state1 = _mm_blend_epi16(state1, tmp, 0xF0); // CDGH
+
+  for(; count; --count, blocks += 64) {
+    const __m128i abefSave = state0, cdghSave = state1;
+    __m128i w[4];
+
+    for(int i = 0; i < 16; ++i) {
+      __m128i &msg = w[i & 3];
+
+      if(i < 4) {
+        msg = _mm_shuffle_epi8(_mm_loadu_si128(
+          reinterpret_cast<const __m128i *>(blocks + i * 16)), byteSwap);
+      }
+      else {
+        // w[i-4] + s0(w[i-3]) + w[i-7] + s1(w[i-1]), four words at a time
+        tmp = _mm_add_epi32(_mm_sha256msg1_epu32(msg, w[(i - 3) & 3]),
+          _mm_alignr_epi8(w[(i - 1) & 3], w[(i - 2) & 3], 4));
+        msg = _mm_sha256msg2_epu32(tmp, w[(i - 1) & 3]);
+      }
+
+      tmp = _mm_add_epi32(msg, _mm_load_si128(reinterpret_cast<const __m128i *>(&K[i * 4])));
+      state1 = _mm_sha256rnds2_epu32(state1, state0, tmp);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(tmp, 0x0E));
+    }
+
+    state0 = _mm_add_epi32(state0, abefSave);
+    state1 = _mm_add_epi32(state1, cdghSave);
+  }
+
+  tmp = _mm_shuffle_epi32(state0, 0x1B); // FEBA
+  state1 = _mm_shuffle_epi32(state1, 0xB1); // DCHG
+  state0 = _mm_blend_epi16(tmp, state1, 0xF0); // DCBA
+  state1 = _mm_alignr_epi8(state1, tmp, 8); // HGFE
+
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(&state[0]), state0);
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(&state[4]), state1);
+}
+
+#define ROTR8(x, n) _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+
+// Compress one block for each of 8 independent messages. The state is
+// stored transposed: state[word * 8 + lane].
+CPU_TARGET("avx2")
+static void compressAVX2x8(uint32_t *state, const unsigned char *const *blocks)
+{
+  alignas(32) uint32_t words[16][8];
+
+  for(int lane = 0; lane < 8; ++lane) {
+    for(int t = 0; t < 16; ++t)
+      words[t][lane] = readBE32(blocks[lane] + t * 4);
+  }
+
+  __m256i w[16];
+  for(int t = 0; t < 16; ++t)
+    w[t] = _mm256_load_si256(reinterpret_cast<const __m256i *>(words[t]));
+
+  __m256i v[8];
+  for(int i = 0; i < 8; ++i)
+    v[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&state[i * 8]));
+
+  __m256i a = v[0], b = v[1], c = v[2], d = v[3],
+          e = v[4], f = v[5], g = v[6], h = v[7];
+
+  for(int t = 0; t < 64; ++t) {
+    __m256i &wt = w[t & 15];
+
+    if(t >= 16) {
+      const __m256i w15 = w[(t - 15) & 15], w2 = w[(t - 2) & 15];
+      const __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(
+        ROTR8(w15, 7), ROTR8(w15, 18)), _mm256_srli_epi32(w15, 3));
+      const __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(
+        ROTR8(w2, 17), ROTR8(w2, 19)), _mm256_srli_epi32(w2, 10));
+      wt = _mm256_add_epi32(_mm256_add_epi32(wt, s0),
+        _mm256_add_epi32(w[(t - 7) & 15], s1));
+    }
+
+    const __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(
+      ROTR8(e, 6), ROTR8(e, 11)), ROTR8(e, 25));
+    const __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f),
+      _mm256_andnot_si256(e, g));
+    const __m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, s1),
+      _mm256_add_epi32(_mm256_add_epi32(ch, wt),
+        _mm256_set1_epi32(static_cast<int>(K[t]))));
+    const __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(
+      ROTR8(a, 2), ROTR8(a, 13)), ROTR8(a, 22));
+    const __m256i maj = _mm256_xor_si256(_mm256_and_si256(a, b),
+      _mm256_and_si256(c, _mm256_xor_si256(a, b)));
+    const __m256i t2 = _mm256_add_epi32(s0, maj);
+
+    h = g; g = f; f = e; e = _mm256_add_epi32(d, t1);
+    d = c; c = b; b = a; a = _mm256_add_epi32(t1, t2);
+  }
+
+  const __m256i out[8] { a, b, c, d, e, f, g, h };
+  for(int i = 0; i < 8; ++i) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(&state[i * 8]),
+      _mm256_add_epi32(v[i], out[i]));
+  }
+}
+
+#undef ROTR8
+#endif
+
+
+SHA256::Backend SHA256::bestBackend()
+{
+  // SHA-NI on a single stream beats 8 AVX2 lanes even for batches
+  if(isSupported(SHANI))
+    return SHANI;
+  else if(isSupported(AVX2))
+    return AVX2;
+  else
+    return Generic;
+}
+
+bool SHA256::isSupported(const Backend backend)
+{
+  switch(backend) {
+  case Generic:
+    return true;
+#ifdef REAPACK_CPU_X86
+  case AVX2:
+    return CPU::hasAVX2();
+  case SHANI:
+    return CPU::hasSHA();
+#else
+  default:
+    return false;
+#endif
+  }
+
+  return false;
+}
+
+SHA256::SHA256(const Backend backend)
+  : m_compress(compressGeneric), m_bufferSize(0), m_length(0)
+{
+#ifdef REAPACK_CPU_X86
+  if(backend == SHANI && isSupported(SHANI))
+    m_compress = compressSHANI;
+#endif
+
+  std::copy(std::begin(H0), std::end(H0), m_state);
+}
+
+void SHA256::addData(const char *data, size_t len)
+{
+  const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+  m_length += len;
+
+  if(m_bufferSize) {
+    const size_t fill = std::min(len, sizeof(m_buffer) - m_bufferSize);
+    memcpy(m_buffer + m_bufferSize, bytes, fill);
+    m_bufferSize += fill;
+    bytes += fill;
+    len -= fill;
+
+    if(m_bufferSize < sizeof(m_buffer))
+      return;
+
+    m_compress(m_state, m_buffer, 1);
+    m_bufferSize = 0;
+  }
+
+  if(const size_t blocks = len / 64) {
+    m_compress(m_state, bytes, blocks);
+    bytes += blocks * 64;
+    len -= blocks * 64;
+  }
+
+  memcpy(m_buffer, bytes, len);
+  m_bufferSize = len;
+}
+
+// Writes the final one or two blocks of a message given its last
+// (len % 64) bytes and returns the number of blocks.
+static size_t padding(unsigned char *out, const unsigned char *tail,
+  const size_t tailSize, const uint64_t length)
+{
+  const size_t blocks = tailSize < 56 ? 1 : 2;
+
+  memset(out, 0, blocks * 64);
+  memcpy(out, tail, tailSize);
+  out[tailSize] = 0x80;
+
+  const uint64_t bits = length * 8;
+  writeBE32(out + blocks * 64 - 8, static_cast<uint32_t>(bits >> 32));
+  writeBE32(out + blocks * 64 - 4, static_cast<uint32_t>(bits));
+
+  return blocks;
+}
+
+void SHA256::getHash(unsigned char *out)
+{
+  unsigned char final[128];
+  m_compress(m_state, final, padding(final, m_buffer, m_bufferSize, m_length));
+
+  for(int i = 0; i < 8; ++i)
+    writeBE32(out + i * 4, m_state[i]);
+}
+
+void SHA256::hashMany(const std::string_view *buffers, const size_t count,
+  unsigned char *out, const Backend backend)
+{
+#ifdef REAPACK_CPU_X86
+  if(backend == AVX2 && count > 1 && isSupported(AVX2)) {
+    struct Lane {
+      size_t message;
+      const unsigned char *data;
+      size_t blocks; // remaining blocks of data, excluding the padding
+      unsigned char padding[128];
+      size_t paddingBlocks;
+      size_t paddingOffset;
+    };
+
+    Lane lanes[8]{}; // lanes without a message keep hashing idleBlock
+    alignas(32) uint32_t state[8 * 8];
+    static const unsigned char idleBlock[64]{};
+    size_t next = 0, active = 0;
+
+    const auto start = [&](Lane &lane, const size_t index) {
+      const std::string_view &buffer = buffers[next];
+      const size_t fullBlocks = buffer.size() / 64;
+
+      lane.message = next++;
+      lane.data = reinterpret_cast<const unsigned char *>(buffer.data());
+      lane.blocks = fullBlocks;
+      lane.paddingBlocks = padding(lane.padding, lane.data + fullBlocks * 64,
+        buffer.size() % 64, buffer.size());
+      lane.paddingOffset = 0;
+
+      for(int i = 0; i < 8; ++i)
+        state[i * 8 + index] = H0[i];
+
+      ++active;
+    };
+
+    for(size_t i = 0; i < 8 && next < count; ++i)
+      start(lanes[i], i);
+
+    while(active) {
+      const unsigned char *blocks[8];
+
+      for(size_t i = 0; i < 8; ++i) {
+        Lane &lane = lanes[i];
+
+        if(lane.blocks)
+          blocks[i] = lane.data;
+        else if(lane.paddingBlocks)
+          blocks[i] = lane.padding + lane.paddingOffset;
+        else
+          blocks[i] = idleBlock;
+      }
+
+      compressAVX2x8(state, blocks);
+
+      for(size_t i = 0; i < 8; ++i) {
+        Lane &lane = lanes[i];
+
+        if(lane.blocks) {
+          lane.data += 64;
+          --lane.blocks;
+          continue;
+        }
+        else if(!lane.paddingBlocks)
+          continue;
+
+        lane.paddingOffset += 64;
+        if(--lane.paddingBlocks)
+          continue;
+
+        unsigned char *digest = out + lane.message * DIGEST_SIZE;
+        for(int w = 0; w < 8; ++w)
+          writeBE32(digest + w * 4, state[w * 8 + i]);
+
+        --active;
+        if(next < count)
+          start(lane, i);
+      }
+    }
+
+    return;
+  }
+#endif
+
+  for(size_t i = 0; i < count; ++i) {
+    SHA256 hash(backend);
+    hash.addData(buffers[i].data(), buffers[i].size());
+    hash.getHash(out + i * DIGEST_SIZE);
+  }
+}
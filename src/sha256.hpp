@@ -0,0 +1,59 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2019  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REAPACK_SHA256_HPP
+#define REAPACK_SHA256_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Portable SHA-256 with optional x86 acceleration selected at runtime:
+// SHA-NI for single streams and AVX2 to hash 8 independent buffers at once.
+class SHA256 {
+public:
+  enum Backend {
+    Generic,
+    AVX2,
+    SHANI,
+  };
+
+  static constexpr size_t DIGEST_SIZE = 32;
+
+  static Backend bestBackend();
+  static bool isSupported(Backend);
+
+  // out receives count * DIGEST_SIZE bytes
+  static void hashMany(const std::string_view *buffers, size_t count,
+    unsigned char *out, Backend = bestBackend());
+
+  SHA256(Backend = bestBackend());
+
+  void addData(const char *data, size_t len);
+  void getHash(unsigned char *out);
+
+private:
+  typedef void (*CompressFunc)(uint32_t *state, const unsigned char *blocks, size_t count);
+
+  CompressFunc m_compress;
+  uint32_t m_state[8];
+  unsigned char m_buffer[64];
+  size_t m_bufferSize;
+  uint64_t m_length;
+};
+
+#endif
@@ -62,6 +62,8 @@ Source::Source(const string &file, const string &url, const Version *ver)
 {
   if(m_url.empty())
     throw reapack_error("empty source url");
+
+  updateTargetPath();
 }
 
 Package::Type Source::type() const
@@ -80,6 +82,15 @@ const string &Source::file() const
     return m_version->package()->name();
 }
 
+void Source::setTypeOverride(const Package::Type type)
+{
+  if(m_type == type)
+    return;
+
+  m_type = type;
+  updateTargetPath();
+}
+
 void Source::setSections(int sections)
 {
   if(type() != Package::ScriptType)
@@ -90,8 +101,13 @@ void Source::setSections(int sections)
   m_sections = sections;
 }
 
-Path Source::targetPath() const
+void Source::updateTargetPath()
 {
+  // computed once when loading the index as the target path is needed
+  // many times during synchronization and installation
+  if(!m_version || !m_version->package())
+    return;
+
   Path path;
   const auto type = this->type();
 
@@ -165,5 +181,5 @@ Path Source::targetPath() const
     break;
   }
 
-  return path;
+  m_targetPath = move(path);
 }
@@ -47,7 +47,7 @@ public:
   Package::Type type() const;
   const std::string &file() const;
   const std::string &url() const { return m_url; }
-  Path targetPath() const;
+  const Path &targetPath() const { return m_targetPath; }
 
   void setChecksum(const std::string &checksum) { m_checksum = checksum; }
   const std::string &checksum() const { return m_checksum; }
@@ -55,13 +55,15 @@ public:
   void setPlatform(Platform p) { m_platform = p; }
   Platform platform() const { return m_platform; }
 
-  void setTypeOverride(Package::Type t) { m_type = t; }
+  void setTypeOverride(Package::Type);
   Package::Type typeOverride() const { return m_type; }
 
   void setSections(int);
   int sections() const { return m_sections; }
 
 private:
+  void updateTargetPath();
+
   Platform m_platform;
   Package::Type m_type;
   std::string m_file;
@@ -65,6 +65,59 @@ string String::indent(const string &text)
   return output;
 }
 
+static char32_t foldCodepoint(const char32_t c)
+{
+  if((c >= 0xC0 && c <= 0xDE && c != 0xD7) || // Latin-1
+      (c >= 0x391 && c <= 0x3AB && c != 0x3A2) || // Greek
+      (c >= 0x410 && c <= 0x42F)) // Cyrillic
+    return c + 0x20;
+  else if(c == 0x178)
+    return 0xFF;
+  else if((c >= 0x100 && c <= 0x137) || (c >= 0x14A && c <= 0x177) ||
+      (c >= 0x460 && c <= 0x481) || (c >= 0x48A && c <= 0x4BF) ||
+      (c >= 0x4D0 && c <= 0x52F))
+    return c | 1; // pairs starting with the uppercase letter
+  else if((c >= 0x139 && c <= 0x148) || (c >= 0x179 && c <= 0x17E) ||
+      (c >= 0x4C1 && c <= 0x4CE))
+    return (c & 1) ? c + 1 : c; // pairs starting with the lowercase letter
+  else if(c >= 0x400 && c <= 0x40F)
+    return c + 0x50;
+  else if(c == 0x386)
+    return 0x3AC;
+  else if(c >= 0x388 && c <= 0x38A)
+    return c + 0x25;
+  else if(c == 0x38C)
+    return 0x3CC;
+  else if(c == 0x38E || c == 0x38F)
+    return c + 0x3F;
+
+  return c;
+}
+
+string String::fold(const string_view text)
+{
+  string folded(text);
+
+  for(size_t i = 0; i < folded.size(); ++i) {
+    const unsigned char c = folded[i];
+
+    if(c >= 'A' && c <= 'Z')
+      folded[i] = c + ('a' - 'A');
+    // all the foldable codepoints are encoded in two bytes, and so are
+    // their lowercase counterpart
+    else if((c & 0xE0) == 0xC0 && i + 1 < folded.size() &&
+        (folded[i + 1] & 0xC0) == 0x80) {
+      const char32_t codepoint = (c & 0x1F) << 6 | (folded[i + 1] & 0x3F);
+      const char32_t lower = foldCodepoint(codepoint);
+
+      folded[i] = static_cast<char>(0xC0 | lower >> 6);
+      folded[++i] = static_cast<char>(0x80 | (lower & 0x3F));
+    }
+  }
+
+  return folded;
+}
+
 void String::ImplDetail::imbueStream(ostream &stream)
 {
   class NumPunct : public std::numpunct<char>
@@ -20,6 +20,7 @@
 
 #include <sstream>
 #include <string>
+#include <string_view>
 
 namespace String {
   namespace ImplDetail {
@@ -33,6 +34,10 @@ namespace String {
 
   std::string indent(const std::string &);
 
+  // Lowercase UTF-8 text for case-insensitive comparisons.
+  // Covers ASCII, Latin-1, Latin Extended-A, Greek and Cyrillic.
+  std::string fold(std::string_view);
+
   template<typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value>>
   std::string number(const T v) {
     std::ostringstream stream;
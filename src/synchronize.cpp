@@ -24,10 +24,50 @@
 #include "reapack.hpp"
 #include "transaction.hpp"
 
+using namespace std;
+
+// Finds which up-to-date packages have missing files, off the main thread.
+class InstalledCheck : public ThreadTask {
+public:
+  typedef pair<const Version *, Registry::Entry> Installed;
+
+  InstalledCheck(const string &remote, vector<Installed> &&list)
+    : m_list(move(list))
+  {
+    setSummary("Checking %s: " + remote);
+  }
+
+  const vector<Installed> &incomplete() const { return m_incomplete; }
+  bool concurrent() const override { return true; }
+
+protected:
+  bool run() override
+  {
+    // packages often share directories: list each of them only once
+    FS::DirCache cache;
+
+    for(const Installed &pkg : m_list) {
+      if(aborted())
+        return false;
+
+      const set<Path> &files = pkg.first->files();
+      if(!all_of(files.begin(), files.end(),
+          [&](const Path &path) { return cache.exists(path); }))
+        m_incomplete.push_back(pkg);
+    }
+
+    return true;
+  }
+
+private:
+  vector<Installed> m_list;
+  vector<Installed> m_incomplete;
+};
+
 SynchronizeTask::SynchronizeTask(const Remote &remote, const bool stale,
     const bool fullSync, const InstallOpts &opts, Transaction *tx)
   : Task(tx), m_remote(remote), m_indexPath(Index::pathFor(m_remote.name())),
-    m_opts(opts), m_stale(stale), m_fullSync(fullSync)
+    m_opts(opts), m_stale(stale), m_fullSync(fullSync), m_downloading(false)
 {
 }
 
@@ -47,10 +87,17 @@ bool SynchronizeTask::start()
   dl->setName(m_remote.name());
 
   dl->onFinishAsync >> [=] {
-    if(dl->save())
+    if(dl->save()) {
+      g_reapack->indexCache()->invalidate(m_remote.name());
       tx()->receipt()->setIndexChanged();
+    }
+
+    // plan and start the installations of this repository right away
+    m_downloading = false;
+    tx()->commitReady();
   };
 
+  m_downloading = true;
   tx()->threadPool()->push(dl);
   return true;
 }
@@ -64,8 +111,15 @@ void SynchronizeTask::commit()
   if(!index || !m_fullSync)
     return;
 
-  for(const Package *pkg : index->packages())
-    synchronize(pkg);
+  vector<UpToDate> installed;
+
+  for(const Package *pkg : index->packages()) {
+    if(const UpToDate &upToDate = synchronize(pkg); upToDate.first)
+      installed.push_back(upToDate);
+  }
+
+  if(!installed.empty())
+    checkInstalled(move(installed));
 
   if(m_opts.promptObsolete && !m_remote.isProtected()) {
     for(const auto &entry : tx()->registry()->getEntries(m_remote.name())) {
@@ -75,24 +129,43 @@ void SynchronizeTask::commit()
   }
 }
 
-void SynchronizeTask::synchronize(const Package *pkg)
+auto SynchronizeTask::synchronize(const Package *pkg) -> UpToDate
 {
   const auto &entry = tx()->registry()->getEntry(pkg);
 
   if(!entry && !m_opts.autoInstall)
-    return;
+    return {};
 
   const Version *latest = pkg->lastVersion(m_opts.bleedingEdge, entry.version);
 
   if(!latest)
-    return;
+    return {};
 
-  if(entry.version == latest->name()) {
-    if(FS::allExists(latest->files()))
-      return; // latest version is really installed, nothing to do here!
-  }
+  // the latest version is already installed: reinstall it only if files are
+  // missing, which is checked for all packages at once in a worker thread
+  if(entry.version == latest->name())
+    return {latest, entry};
   else if(entry.pinned || latest->name() < entry.version)
-    return;
+    return {};
 
   tx()->install(latest, entry);
+  return {};
+}
+
+void SynchronizeTask::checkInstalled(vector<UpToDate> &&list)
+{
+  Transaction *tx = this->tx(); // this task is gone once the check finishes
+  InstalledCheck *job = new InstalledCheck(m_remote.name(), move(list));
+
+  job->onFinishAsync >> [=] {
+    if(job->state() != ThreadTask::Success)
+      return;
+
+    for(const auto &[version, entry] : job->incomplete())
+      tx->install(version, entry);
+
+    tx->commitReady();
+  };
+
+  tx->threadPool()->push(job);
 }
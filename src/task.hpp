@@ -23,12 +23,15 @@
 #include "registry.hpp"
 #include "remote.hpp"
 
+#include <map>
 #include <memory>
 #include <set>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 class ArchiveReader;
+class ArchiveWriter;
 class Index;
 class Source;
 class ThreadTask;
@@ -37,6 +40,7 @@ class Version;
 struct InstallOpts;
 
 typedef std::shared_ptr<ArchiveReader> ArchiveReaderPtr;
+typedef std::shared_ptr<ArchiveWriter> ArchiveWriterPtr;
 typedef std::shared_ptr<const Index> IndexPtr;
 
 class Task {
@@ -48,10 +52,15 @@ public:
   virtual void commit() = 0;
   virtual void rollback() {}
 
+  // whether commit() may run before the rest of the queue has finished
+  virtual bool ready() const { return false; }
+  virtual int priority() const { return 0; }
+  // redo the temporary registry changes of start() (see Transaction::runQueue)
+  virtual void reserve() {}
+
   bool operator<(const Task &o) { return priority() < o.priority(); }
 
 protected:
-  virtual int priority() const { return 0; }
   Transaction *tx() const { return m_tx; }
 
 private:
@@ -67,15 +76,20 @@ public:
 protected:
   bool start() override;
   void commit() override;
+  bool ready() const override { return !m_downloading; }
 
 private:
-  void synchronize(const Package *);
+  typedef std::pair<const Version *, Registry::Entry> UpToDate;
+
+  UpToDate synchronize(const Package *);
+  void checkInstalled(std::vector<UpToDate> &&);
 
   Remote m_remote;
   Path m_indexPath;
   InstallOpts m_opts;
   bool m_stale;
   bool m_fullSync;
+  bool m_downloading;
 };
 
 class InstallTask : public Task {
@@ -86,9 +100,14 @@ public:
   bool start() override;
   void commit() override;
   void rollback() override;
+  bool ready() const override { return m_waiting.empty(); }
+  void reserve() override;
+
+  // only replace these files, keeping the rest of the package as is
+  void setFiles(const std::set<Path> &files) { m_only = files; }
 
 private:
-  void push(ThreadTask *, const TempPath &);
+  void push(ThreadTask *, const TempPath &, const std::string &checksum = {});
 
   const Version *m_version;
   bool m_pin;
@@ -97,8 +116,12 @@ private:
 
   bool m_fail;
   IndexPtr m_index; // keep in memory
+  std::set<Path> m_only;
   std::vector<Registry::File> m_oldFiles;
+  std::vector<Registry::File> m_keptFiles;
   std::vector<TempPath> m_newFiles;
+  std::map<Path, std::string> m_checksums;
+  std::set<Path> m_unchanged; // already installed files matching the checksum
   std::unordered_set<ThreadTask *> m_waiting;
 };
 
@@ -108,6 +131,7 @@ public:
 
 protected:
   int priority() const override { return 1; }
+  bool ready() const override { return true; }
   bool start() override;
   void commit() override;
 
@@ -122,6 +146,7 @@ public:
   PinTask(const Registry::Entry &, bool pin, Transaction *);
 
 protected:
+  bool ready() const override { return true; }
   void commit() override;
 
 private:
@@ -129,9 +154,26 @@ private:
   bool m_pin;
 };
 
+class VerifyTask : public Task {
+public:
+  VerifyTask(bool repair, Transaction *);
+
+protected:
+  bool start() override;
+  void commit() override;
+  void rollback() override;
+  bool ready() const override { return m_waiting.empty(); }
+
+private:
+  bool m_repair;
+  std::unordered_map<Registry::Entry, std::set<Path>> m_mismatches;
+  std::unordered_set<ThreadTask *> m_waiting;
+};
+
 class ExportTask : public Task {
 public:
-  ExportTask(const std::string &path, Transaction *);
+  ExportTask(const std::string &path, const std::string &basePath,
+    Transaction *);
 
 protected:
   bool start() override;
@@ -140,6 +182,9 @@ protected:
 
 private:
   TempPath m_path;
+  Path m_basePath;
+  ArchiveWriterPtr m_writer;
+  std::map<Path, std::string> m_checksums;
 };
 
 #endif
@@ -116,12 +116,20 @@ void WorkerThread::push(ThreadTask *task)
 }
 
 ThreadPool::~ThreadPool()
+{
+  shutdown();
+}
+
+void ThreadPool::shutdown()
 {
   // don't emit ThreadPool::onAbort from the destructor
   // which is most likely to cause a crash
   onAbort.reset();
 
   abort();
+
+  for(auto &thread : m_pool)
+    thread.reset();
 }
 
 void ThreadPool::push(ThreadTask *task)
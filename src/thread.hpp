@@ -96,6 +96,7 @@ public:
 
   void push(ThreadTask *);
   void abort();
+  void shutdown();
 
   bool idle() const { return m_running.empty(); }
 
@@ -69,6 +69,16 @@ int Time::compare(const Time &o) const
   return 0;
 }
 
+int64_t Time::sortKey() const
+{
+  int64_t key = 0;
+
+  for(const int part : {year(), month(), day(), hour(), minute(), second()})
+    key = key * 100 + part;
+
+  return key;
+}
+
 ostream &operator<<(ostream &os, const Time &time)
 {
   os << time.toString();
@@ -18,6 +18,7 @@
 #ifndef REAPACK_TIME_HPP
 #define REAPACK_TIME_HPP
 
+#include <cstdint>
 #include <ctime>
 #include <string>
 
@@ -38,6 +39,8 @@ public:
   int second() const { return m_tm.tm_sec; }
 
   std::string toString() const;
+  // YYYYMMDDhhmmss as a number, ordered like compare()
+  std::int64_t sortKey() const;
 
   int compare(const Time &) const;
   bool operator<(const Time &o) const { return compare(o) < 0; }
@@ -32,23 +32,33 @@
 
 using namespace std;
 
-Transaction::Transaction()
-  : m_isCancelled(false), m_registry(Path::REGISTRY.prependRoot())
+Transaction::Transaction(ThreadPool *threadPool)
+  : m_isCancelled(false), m_isFinished(false),
+    m_registry(Path::REGISTRY.prependRoot()), m_journal(Path::JOURNAL),
+    m_threadPool(threadPool)
 {
-  m_threadPool.onPush >> [this] (ThreadTask *task) {
+  m_threadPool->onPush >> [this] (ThreadTask *task) {
     task->onFinishAsync >> [=] {
       if(task->state() == ThreadTask::Failure)
         m_receipt.addError(task->error());
     };
   };
 
-  m_threadPool.onAbort >> [this] {
+  m_threadPool->onAbort >> [this] {
     m_isCancelled = true;
     queue<HostTicket>().swap(m_regQueue);
   };
 
   // run the next task queue when the current one is done
-  m_threadPool.onDone >> bind(&Transaction::runTasks, this);
+  m_threadPool->onDone >> bind(&Transaction::runTasks, this);
+}
+
+Transaction::~Transaction()
+{
+  // the thread pool outlives this transaction: detach from it
+  m_threadPool->onPush.reset();
+  m_threadPool->onAbort.reset();
+  m_threadPool->onDone.reset();
 }
 
 void Transaction::synchronize(const Remote &remote,
@@ -91,7 +101,7 @@ IndexPtr Transaction::loadIndex(const Remote &remote)
     return it->second;
 
   try {
-    const IndexPtr &ri = Index::load(remote.name());
+    const IndexPtr &ri = g_reapack->indexCache()->load(remote.name());
     m_indexes[remote.name()] = ri;
     return ri;
   }
@@ -114,6 +124,14 @@ void Transaction::install(const Version *ver, const Registry::Entry &oldEntry,
   m_nextQueue.push(make_shared<InstallTask>(ver, pin, oldEntry, reader, this));
 }
 
+void Transaction::repair(const Version *ver, const Registry::Entry &entry,
+  const set<Path> &files)
+{
+  auto task = make_shared<InstallTask>(ver, false, entry, nullptr, this);
+  task->setFiles(files);
+  m_nextQueue.push(task);
+}
+
 void Transaction::setPinned(const Registry::Entry &entry, const bool pinned)
 {
   m_nextQueue.push(make_shared<PinTask>(entry, pinned, this));
@@ -130,6 +148,8 @@ void Transaction::uninstall(const Remote &remote)
       m_receipt.addError({FS::lastError(), indexPath.join()});
   }
 
+  g_reapack->indexCache()->invalidate(remote.name());
+
   for(const auto &entry : m_registry.getEntries(remote.name()))
     uninstall(entry);
 }
@@ -139,13 +159,28 @@ void Transaction::uninstall(const Registry::Entry &entry)
   m_nextQueue.push(make_shared<UninstallTask>(entry, this));
 }
 
-void Transaction::exportArchive(const string &path)
+void Transaction::exportArchive(const string &path, const string &basePath)
+{
+  m_nextQueue.push(make_shared<ExportTask>(path, basePath, this));
+}
+
+void Transaction::verify(const bool repair)
 {
-  m_nextQueue.push(make_shared<ExportTask>(path, this));
+  m_nextQueue.push(make_shared<VerifyTask>(repair, this));
 }
 
 bool Transaction::runTasks()
 {
+  if(m_isFinished)
+    return true;
+
+  // start the tasks added while others are still running without waiting
+  // for the whole pipeline to be idle
+  if(!m_threadPool->idle()) {
+    commitReady();
+    return false;
+  }
+
   do {
     if(!m_nextQueue.empty()) {
       m_taskQueues.push(m_nextQueue);
@@ -165,11 +200,17 @@ bool Transaction::runTasks()
       runQueue(m_taskQueues.front());
       m_taskQueues.pop();
 
+      commitReady();
+
       if(!commitTasks())
         return false; // if the tasks didn't finish immediately (downloading)
     }
   } while(!m_nextQueue.empty()); // restart if a task's commit() added new tasks
 
+  // a task's commit() may have started more work (eg. checking installed files)
+  if(!m_threadPool->idle())
+    return false;
+
   finish(); // we're done!
 
   return true;
@@ -179,11 +220,15 @@ void Transaction::runQueue(TaskQueue &queue)
 {
   m_registry.savepoint();
 
+  // let the new tasks detect conflicts with the installations in progress
+  for(const TaskPtr &task : m_runningTasks)
+    task->reserve();
+
   while(!queue.empty()) {
     const TaskPtr &task = queue.top();
 
     if(task->start())
-      m_runningTasks.push(task);
+      m_runningTasks.push_back(task);
 
     queue.pop();
   }
@@ -194,7 +239,7 @@ void Transaction::runQueue(TaskQueue &queue)
 bool Transaction::commitTasks()
 {
   // wait until all running tasks are ready
-  if(!m_threadPool.idle())
+  if(!m_threadPool->idle())
     return false;
 
   // finish current tasks
@@ -204,15 +249,63 @@ bool Transaction::commitTasks()
     else
       m_runningTasks.front()->commit();
 
-    m_runningTasks.pop();
+    m_runningTasks.pop_front();
   }
 
   return true;
 }
 
+void Transaction::commitReady()
+{
+  if(m_isCancelled)
+    return;
+
+  bool committed = false;
+
+  while(true) {
+    // Tasks of equal priority may commit in any order (as in a TaskQueue), but
+    // not before the higher-priority ones (eg. uninstallations freeing paths).
+    const Task *waiting = nullptr;
+
+    for(auto it = m_runningTasks.begin(); it != m_runningTasks.end();) {
+      const TaskPtr &task = *it;
+
+      if(waiting && task->priority() < waiting->priority())
+        break;
+      else if(!task->ready()) {
+        if(!waiting)
+          waiting = task.get();
+
+        ++it;
+        continue;
+      }
+
+      task->commit();
+      it = m_runningTasks.erase(it);
+      committed = true;
+    }
+
+    // obsolete packages must be uninstalled first: wait for promptObsolete()
+    if(m_nextQueue.empty() || !m_obsolete.empty())
+      break;
+
+    // start the installations planned by the synchronizations committed above
+    // without waiting for the indexes of the other repositories
+    TaskQueue queue;
+    queue.swap(m_nextQueue);
+    runQueue(queue);
+  }
+
+  if(committed)
+    registerQueued();
+}
+
 void Transaction::finish()
 {
+  m_isFinished = true;
+
   m_registry.commit();
+  m_journal.save();
   registerQueued();
 
   onFinish();
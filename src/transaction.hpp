@@ -19,12 +19,14 @@
 #define REAPACK_TRANSACTION_HPP
 
 #include "event.hpp"
+#include "journal.hpp"
 #include "receipt.hpp"
 #include "registry.hpp"
 #include "task.hpp"
 #include "thread.hpp"
 
 #include <functional>
+#include <list>
 #include <memory>
 #include <optional>
 #include <set>
@@ -36,6 +38,7 @@ class Path;
 class Remote;
 class SynchronizeTask;
 class UninstallTask;
+class VerifyTask;
 
 typedef std::shared_ptr<Task> TaskPtr;
 
@@ -46,7 +49,8 @@ public:
   typedef std::function<void()> CleanupHandler;
   typedef std::function<bool(std::vector<Registry::Entry> &)> ObsoleteHandler;
 
-  Transaction();
+  Transaction(ThreadPool *);
+  ~Transaction();
 
   void setCleanupHandler(const CleanupHandler &cb) { m_cleanupHandler = cb; }
   void setObsoleteHandler(const ObsoleteHandler &cb) { m_promptObsolete = cb; }
@@ -61,14 +65,18 @@ public:
   void setPinned(const Registry::Entry &, bool pinned);
   void uninstall(const Remote &);
   void uninstall(const Registry::Entry &);
-  void exportArchive(const std::string &path);
+  void repair(const Version *, const Registry::Entry &, const std::set<Path> &files);
+  void exportArchive(const std::string &path, const std::string &basePath = {});
+  void verify(bool repair);
   bool runTasks();
 
   bool isCancelled() const { return m_isCancelled; }
+  bool isFinished() const { return m_isFinished; }
 
   Receipt *receipt() { return &m_receipt; }
   Registry *registry() { return &m_registry; }
-  ThreadPool *threadPool() { return &m_threadPool; }
+  Journal *journal() { return &m_journal; }
+  ThreadPool *threadPool() { return m_threadPool; }
 
   Event<void()> onFinish;
 
@@ -76,11 +84,13 @@ protected:
   friend SynchronizeTask;
   friend InstallTask;
   friend UninstallTask;
+  friend VerifyTask;
 
   IndexPtr loadIndex(const Remote &);
   void addObsolete(const Registry::Entry &e) { m_obsolete.insert(e); }
   void registerAll(bool add, const Registry::Entry &);
   void registerFile(const HostTicket &t) { m_regQueue.push(t); }
+  void commitReady();
 
 private:
   class CompareTask {
@@ -103,7 +113,9 @@ private:
   void finish();
 
   bool m_isCancelled;
+  bool m_isFinished;
   Registry m_registry;
+  Journal m_journal;
   Receipt m_receipt;
 
   std::unordered_set<std::string> m_syncedRemotes;
@@ -111,10 +123,10 @@ private:
   std::unordered_set<std::string> m_inhibited;
   std::unordered_set<Registry::Entry> m_obsolete;
 
-  ThreadPool m_threadPool;
+  ThreadPool *m_threadPool;
   TaskQueue m_nextQueue;
   std::queue<TaskQueue> m_taskQueues;
-  std::queue<TaskPtr> m_runningTasks;
+  std::list<TaskPtr> m_runningTasks;
   std::queue<HostTicket> m_regQueue;
 
   CleanupHandler m_cleanupHandler;
@@ -0,0 +1,201 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2019  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "task.hpp"
+
+#include "filesystem.hpp"
+#include "hash.hpp"
+#include "index.hpp"
+#include "reapack.hpp"
+#include "transaction.hpp"
+
+#include <fstream>
+
+using namespace std;
+
+class FileVerifier : public ThreadTask {
+public:
+  enum Result {
+    Unchanged,
+    Modified,
+    Missing,
+  };
+
+  FileVerifier(const Registry::Entry &entry, vector<Registry::File> &&files)
+    : m_files(move(files)), m_results(m_files.size(), Unchanged)
+  {
+    setSummary("Verifying %s: " + entry.package);
+  }
+
+  const vector<Registry::File> &files() const { return m_files; }
+  Result result(const size_t i) const { return m_results[i]; }
+  const vector<ErrorInfo> &errors() const { return m_errors; }
+  bool concurrent() const override { return true; }
+
+protected:
+  bool run() override
+  {
+    // small SHA-256 files are read first and then hashed several at a time
+    constexpr uint64_t MAX_BATCHED_SIZE = 256 * 1024;
+
+    vector<size_t> batch;
+    vector<string> contents;
+
+    for(size_t i = 0; i < m_files.size() && !aborted(); ++i) {
+      const Registry::File &file = m_files[i];
+
+      FS::FileInfo info;
+      if(!FS::getInfo(file.path, &info)) {
+        m_results[i] = Missing;
+        continue;
+      }
+
+      // installed by an older version of ReaPack: only check its existence
+      Hash::Algorithm algo;
+      if(!Hash::getAlgorithm(file.checksum, &algo))
+        continue;
+
+      if(info.size != file.size) {
+        m_results[i] = Modified;
+        continue;
+      }
+
+      if(algo == Hash::SHA256 && info.size <= MAX_BATCHED_SIZE) {
+        string data(static_cast<size_t>(info.size), '\0');
+
+        ifstream stream;
+        if(!FS::open(stream, file.path) || !stream.read(data.data(), data.size())) {
+          readError(i);
+          continue;
+        }
+
+        batch.push_back(i);
+        contents.push_back(move(data));
+        continue;
+      }
+
+      string checksum;
+      if(!Hash::fromFile(file.path, algo, &checksum)) {
+        readError(i);
+        continue;
+      }
+
+      if(checksum != file.checksum)
+        m_results[i] = Modified;
+    }
+
+    const vector<string_view> buffers(contents.begin(), contents.end());
+    const vector<string> &checksums = Hash::digestMany(Hash::SHA256, buffers);
+
+    for(size_t i = 0; i < batch.size(); ++i) {
+      if(checksums[i] != m_files[batch[i]].checksum)
+        m_results[batch[i]] = Modified;
+    }
+
+    return true;
+  }
+
+private:
+  // the file cannot be trusted but the rest of the package can still be checked
+  void readError(const size_t i)
+  {
+    m_results[i] = Modified;
+    m_errors.push_back({FS::lastError(), m_files[i].path.join()});
+  }
+
+  vector<Registry::File> m_files;
+  vector<Result> m_results;
+  vector<ErrorInfo> m_errors;
+};
+
+VerifyTask::VerifyTask(const bool repair, Transaction *tx)
+  : Task(tx), m_repair(repair)
+{
+}
+
+bool VerifyTask::start()
+{
+  // including packages from repositories that were removed since
+  for(const Registry::Entry &entry : tx()->registry()->getEntries()) {
+    vector<Registry::File> files = tx()->registry()->getFiles(entry);
+    if(files.empty())
+      continue;
+
+    FileVerifier *job = new FileVerifier(entry, move(files));
+
+    job->onFinishAsync >> [=] {
+      m_waiting.erase(job);
+
+      if(job->state() == ThreadTask::Success) {
+        for(const ErrorInfo &error : job->errors())
+          tx()->receipt()->addError(error);
+
+        for(size_t i = 0; i < job->files().size(); ++i) {
+          const FileVerifier::Result result = job->result(i);
+          if(result == FileVerifier::Unchanged)
+            continue;
+
+          const Path &path = job->files()[i].path;
+          tx()->receipt()->addMismatch(path, result == FileVerifier::Missing);
+          m_mismatches[entry].insert(path);
+        }
+      }
+
+      if(m_waiting.empty())
+        tx()->commitReady();
+    };
+
+    m_waiting.insert(job);
+    tx()->threadPool()->push(job);
+  }
+
+  return true;
+}
+
+void VerifyTask::commit()
+{
+  tx()->receipt()->setVerified();
+
+  if(!m_repair)
+    return;
+
+  for(const auto &[entry, files] : m_mismatches) {
+    const Version *ver = nullptr;
+
+    if(const Remote &remote = g_reapack->remote(entry.remote)) {
+      if(const IndexPtr &index = tx()->loadIndex(remote)) {
+        if(const Package *pkg = index->find(entry.category, entry.package))
+          ver = pkg->findVersion(entry.version);
+      }
+    }
+
+    if(!ver) {
+      tx()->receipt()->addError({String::format(
+        "Cannot repair: v%s is no longer available",
+        entry.version.toString().c_str()), entry.package});
+      continue;
+    }
+
+    tx()->repair(ver, entry, files);
+  }
+}
+
+void VerifyTask::rollback()
+{
+  for(ThreadTask *job : m_waiting)
+    job->abort();
+}
@@ -62,7 +62,7 @@ bool Version::addSource(const Source *source)
   else if(!source->platform().test())
     return false;
 
-  const Path path = source->targetPath();
+  const Path &path = source->targetPath();
 
   if(m_files.count(path))
     return false;
@@ -204,3 +204,46 @@ int VersionName::compare(const VersionName &o) const
 
   return 0;
 }
+
+string VersionName::sortKey() const
+{
+  // Missing segments compare as zeros, so a run of zeros is decided by the
+  // segment ending it: letters after fewer zeros sort lower, numbers higher.
+  enum Tag : char { LettersTag = 1, EndTag = 2, NumberTag = 3 };
+
+  const auto put16 = [](string &key, const unsigned int value) {
+    key += static_cast<char>(value >> 8 & 0xff);
+    key += static_cast<char>(value & 0xff);
+  };
+
+  if(m_segments.empty())
+    return {};
+
+  string key;
+  unsigned int zeros = 0;
+
+  for(const Segment &segment : m_segments) {
+    if(const Numeric *number = get_if<Numeric>(&segment)) {
+      if(!*number) {
+        ++zeros;
+        continue;
+      }
+
+      key += NumberTag;
+      put16(key, 0xffff - zeros);
+      put16(key, *number);
+    }
+    else {
+      key += LettersTag;
+      put16(key, zeros);
+      key += get<string>(segment);
+      key += '\0';
+    }
+
+    zeros = 0;
+  }
+
+  key += EndTag;
+
+  return key;
+}
@@ -44,6 +44,8 @@ public:
   const std::string &toString() const { return m_string; }
 
   int compare(const VersionName &) const;
+  // bytes ordered like compare() when compared as plain strings
+  std::string sortKey() const;
   bool operator<(const VersionName &o) const { return compare(o) < 0; }
   bool operator<=(const VersionName &o) const { return compare(o) <= 0; }
   bool operator>(const VersionName &o) const { return compare(o) > 0; }
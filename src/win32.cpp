@@ -85,28 +85,3 @@ HANDLE Win32::globalCopy(const string &text)
 
   return mem;
 }
-
-bool Win32::writePrivateProfileString(const char *group, const char *key,
-  const char *value, const char *path)
-{
-  // value can be null for deleting a key
-  return WritePrivateProfileString(widen_cstr(group), widen_cstr(key),
-    value ? widen_cstr(value) : nullptr, widen_cstr(path));
-}
-
-string Win32::getPrivateProfileString(const char *group, const char *key,
-  const char *fallback, const char *path)
-{
-  char_type buffer[4096];
-  GetPrivateProfileString(widen_cstr(group), widen_cstr(key), widen_cstr(fallback),
-    buffer, static_cast<DWORD>(size(buffer)), widen_cstr(path));
-
-  return narrow(buffer);
-}
-
-unsigned int Win32::getPrivateProfileInt(const char *group, const char *key,
-  const unsigned int fallback, const char *path)
-{
-  return GetPrivateProfileInt(widen_cstr(group), widen_cstr(key),
-    fallback, widen_cstr(path));
-}
@@ -54,10 +54,6 @@ namespace Win32 {
   std::string getWindowText(HWND handle);
   void shellExecute(const char *what, const char *arg = nullptr);
   HANDLE globalCopy(const std::string &);
-
-  bool writePrivateProfileString(const char *g, const char *k, const char *v, const char *p);
-  std::string getPrivateProfileString(const char *g, const char *k, const char *v, const char *p);
-  unsigned int getPrivateProfileInt(const char *g, const char *k, unsigned int f, const char *p);
 };
 
 #endif
@@ -0,0 +1,318 @@
+#include "helper.hpp"
+
+#include <archive.hpp>
+#include <errors.hpp>
+#include <filesystem.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <sstream>
+#include <thread>
+
+#include <reaper_plugin_functions.h>
+#include <zlib/unzip.h>
+
+static const char *M = "[archive]";
+static const Path ARCHIVE_PATH("test/archive.zip");
+
+static std::string extract(ArchiveReader &reader, const Path &path)
+{
+  std::ostringstream stream;
+  REQUIRE(reader.extractFile(path, stream) == 0);
+  return stream.str();
+}
+
+static std::string sampleData(const size_t size, const unsigned int seed)
+{
+  // mostly text-like data with some noise so it deflates reasonably
+  std::mt19937 random(seed);
+  std::string data(size, 0);
+  for(size_t i = 0; i < size; ++i)
+    data[i] = random() % 8 ? 'a' + (i % 26) : static_cast<char>(random());
+  return data;
+}
+
+TEST_CASE("append compressed entries in reservation order", M) {
+  const std::string &big = sampleData(6 * 1024 * 1024, 42); // spooled to disk
+
+  {
+    ArchiveWriter writer(ARCHIVE_PATH);
+    const size_t first = writer.reserve(), second = writer.reserve(),
+                 third = writer.reserve();
+
+    std::istringstream c(big), b("world"), a("hello");
+    REQUIRE(writer.compress(third, Path("c"), c) == 0);
+    REQUIRE(writer.compress(second, Path("b/b"), b) == 0);
+    REQUIRE(writer.compress(first, Path("a"), a) == 0);
+
+    REQUIRE(writer.close() == 0);
+    REQUIRE(writer.errors().empty());
+  }
+
+  ArchiveReader reader(ARCHIVE_PATH);
+  REQUIRE(extract(reader, Path("a")) == "hello");
+  REQUIRE(extract(reader, Path("b/b")) == "world");
+  REQUIRE(extract(reader, Path("c")) == big);
+
+  FS::remove(ARCHIVE_PATH);
+}
+
+TEST_CASE("skip reserved archive entries", M) {
+  {
+    ArchiveWriter writer(ARCHIVE_PATH);
+    const size_t first = writer.reserve(), second = writer.reserve();
+
+    std::istringstream stream("world");
+    REQUIRE(writer.compress(second, Path("b"), stream) == 0);
+    writer.skip(first);
+    REQUIRE(writer.close() == 0);
+  }
+
+  ArchiveReader reader(ARCHIVE_PATH);
+  std::ostringstream stream;
+  REQUIRE(reader.extractFile(Path("a"), stream) != 0);
+  REQUIRE(extract(reader, Path("b")) == "world");
+
+  FS::remove(ARCHIVE_PATH);
+}
+
+TEST_CASE("store incompressible files without compression", M) {
+  std::string noise(64 * 1024, 0);
+  std::mt19937 random(42);
+  for(char &c : noise)
+    c = static_cast<char>(random());
+
+  const std::string &text = sampleData(64 * 1024, 42);
+
+  const auto methodOf = [](const char *name) {
+    unzFile zip = unzOpen64(ARCHIVE_PATH.join().c_str());
+    unz_file_info64 info{};
+    REQUIRE(unzLocateFile(zip, name, 1) == UNZ_OK);
+    REQUIRE(unzGetCurrentFileInfo64(zip, &info,
+      nullptr, 0, nullptr, 0, nullptr, 0) == UNZ_OK);
+    unzClose(zip);
+    return info.compression_method;
+  };
+
+  SECTION("balanced") {
+    {
+      ArchiveWriter writer(ARCHIVE_PATH);
+      std::istringstream png(text), wav(text), bin(noise), txt(text);
+      writer.addFile(Path("screenshot.PNG"), png);
+      writer.addFile(Path("sample.wav"), wav);
+      writer.addFile(Path("noise.bin"), bin);
+      writer.addFile(Path("script.lua"), txt);
+    }
+
+    REQUIRE(methodOf("screenshot.PNG") == 0);
+    REQUIRE(methodOf("sample.wav") == Z_DEFLATED);
+    REQUIRE(methodOf("noise.bin") == 0);
+    REQUIRE(methodOf("script.lua") == Z_DEFLATED);
+  }
+
+  SECTION("fast") {
+    {
+      ArchiveWriter writer(ARCHIVE_PATH, ArchiveOpts::FastCompression);
+      std::istringstream wav(text), txt(text);
+      writer.addFile(Path("sample.wav"), wav);
+      writer.addFile(Path("script.lua"), txt);
+    }
+
+    REQUIRE(methodOf("sample.wav") == 0);
+    REQUIRE(methodOf("script.lua") == Z_DEFLATED);
+  }
+
+  ArchiveReader reader(ARCHIVE_PATH);
+  REQUIRE(extract(reader, Path("script.lua")) == text);
+  REQUIRE(extract(reader, Path("sample.wav")) == text);
+
+  FS::remove(ARCHIVE_PATH);
+}
+
+TEST_CASE("extract files concurrently", M) {
+  constexpr size_t FILES = 64;
+
+  {
+    ArchiveWriter writer(ARCHIVE_PATH);
+    for(size_t i = 0; i < FILES; ++i) {
+      std::istringstream stream(sampleData(64 * 1024, i));
+      REQUIRE(writer.addFile(Path("dir") + std::to_string(i), stream) == 0);
+    }
+  }
+
+  ArchiveReader reader(ARCHIVE_PATH);
+
+  std::atomic<size_t> next = 0, matches = 0;
+  std::vector<std::thread> threads;
+  for(size_t i = 0; i < 4; ++i) {
+    threads.emplace_back([&] {
+      for(size_t file; (file = next++) < FILES;) {
+        std::ostringstream stream;
+        if(reader.extractFile(Path("dir") + std::to_string(file), stream) == 0
+            && stream.str() == sampleData(64 * 1024, file))
+          ++matches;
+      }
+    });
+  }
+
+  for(std::thread &thread : threads)
+    thread.join();
+
+  REQUIRE(matches == FILES);
+
+  std::ostringstream stream;
+  REQUIRE(reader.extractFile(Path("dir/missing"), stream) != 0);
+
+  FS::remove(ARCHIVE_PATH);
+}
+
+TEST_CASE("read files from the base of an incremental archive", M) {
+  const Path incrementalPath("test/incremental.zip");
+
+  {
+    ArchiveWriter writer(ARCHIVE_PATH);
+    std::istringstream a("hello"), b("world"), manifest("1220aa\ta\n1220bb\tb\n");
+    writer.addFile(Path("a"), a);
+    writer.addFile(Path("b"), b);
+    writer.addFile(Path("manifest"), manifest);
+  }
+
+  {
+    ArchiveWriter writer(incrementalPath);
+    std::istringstream b("bonjour"),
+      manifest("BASE archive.zip\n1220aa\ta\n1220cc\tb\n");
+    writer.addFile(Path("b"), b);
+    writer.addFile(Path("manifest"), manifest);
+  }
+
+  {
+    ArchiveReader reader(incrementalPath);
+    REQUIRE(extract(reader, Path("a")) == "hello");
+    REQUIRE(extract(reader, Path("b")) == "bonjour");
+    REQUIRE(*reader.checksum(Path("b")) == "1220cc");
+    REQUIRE(reader.checksum(Path("c")) == nullptr);
+  }
+
+  {
+    // b failed to be exported: it is neither stored nor in the manifest
+    ArchiveWriter writer(incrementalPath);
+    std::istringstream manifest("BASE archive.zip\n1220aa\ta\n");
+    writer.addFile(Path("manifest"), manifest);
+  }
+
+  {
+    ArchiveReader reader(incrementalPath);
+    REQUIRE(extract(reader, Path("a")) == "hello");
+
+    std::ostringstream stream;
+    REQUIRE(reader.extractFile(Path("b"), stream) == UNZ_END_OF_LIST_OF_FILE);
+  }
+
+  FS::remove(ARCHIVE_PATH);
+  REQUIRE_THROWS_AS(ArchiveReader(incrementalPath), reapack_error);
+
+  FS::remove(incrementalPath);
+}
+
+TEST_CASE("reject base archives outside of the directory", M) {
+  const char *names[] = {"../archive.zip", "dir/archive.zip", "dir\\archive.zip", ".."};
+
+  for(const char *name : names) {
+    {
+      ArchiveWriter writer(ARCHIVE_PATH);
+      std::istringstream manifest(std::string("BASE ") + name + "\n");
+      writer.addFile(Path("manifest"), manifest);
+    }
+
+    REQUIRE_THROWS_AS(ArchiveReader(ARCHIVE_PATH), reapack_error);
+  }
+
+  FS::remove(ARCHIVE_PATH);
+}
+
+TEST_CASE("skip files unchanged since the base archive", M) {
+  plugin_register = [](const char *, void *) { return 0; };
+
+  const Path file("test/archive_file");
+  FS::write(file, "hello world");
+
+  static const char *CHECKSUM =
+    "1220b94d27b9934d3e08a52e52d7da7dabfac484efe37a5380ee9088f7ace2efcde9";
+
+  {
+    auto writer = std::make_shared<ArchiveWriter>(ARCHIVE_PATH);
+
+    FileCompressor unchanged(file, writer);
+    unchanged.setBaseChecksum(CHECKSUM);
+    REQUIRE(unchanged.run());
+    REQUIRE(unchanged.unchanged());
+    REQUIRE(unchanged.checksum() == CHECKSUM);
+
+    FileCompressor changed(file, writer);
+    changed.setBaseChecksum("1220aa");
+    REQUIRE(changed.run());
+    REQUIRE_FALSE(changed.unchanged());
+    REQUIRE(changed.checksum() == CHECKSUM);
+  }
+
+  ArchiveReader reader(ARCHIVE_PATH);
+  REQUIRE(extract(reader, file) == "hello world");
+
+  FS::remove(ARCHIVE_PATH);
+  FS::remove(file);
+}
+
+TEST_CASE("export 2 GB of installed files", "[archive][.benchmark]") {
+  // the compressors' AsyncEvents register a timer with REAPER
+  plugin_register = [](const char *, void *) { return 0; };
+
+  constexpr size_t FILES = 256, FILE_SIZE = 8 * 1024 * 1024;
+  const Path dir("test/archive_bench");
+
+  std::vector<Path> files;
+  for(size_t i = 0; i < FILES; ++i) {
+    files.push_back(dir + std::to_string(i));
+    FS::write(files.back(), sampleData(FILE_SIZE, i));
+  }
+
+  const auto exportWith = [&](const unsigned int threadCount) {
+    const auto start = std::chrono::steady_clock::now();
+
+    {
+      auto writer = std::make_shared<ArchiveWriter>(ARCHIVE_PATH);
+      std::vector<std::unique_ptr<FileCompressor>> jobs;
+      for(const Path &file : files)
+        jobs.push_back(std::make_unique<FileCompressor>(file, writer));
+
+      std::atomic<size_t> next = 0;
+      std::vector<std::thread> threads;
+      for(unsigned int i = 0; i < threadCount; ++i) {
+        threads.emplace_back([&] {
+          for(size_t job; (job = next++) < jobs.size();)
+            jobs[job]->run();
+        });
+      }
+
+      for(std::thread &thread : threads)
+        thread.join();
+
+      REQUIRE(writer->close() == 0);
+      REQUIRE(writer->errors().empty());
+    }
+
+    const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+    WARN("exported " << FILES * FILE_SIZE / (1024 * 1024) << " MiB using "
+      << threadCount << " thread(s) in " << elapsed.count() << " s");
+
+    FS::remove(ARCHIVE_PATH);
+  };
+
+  exportWith(1);
+  exportWith(std::max(3u, std::thread::hardware_concurrency()));
+
+  for(const Path &file : files)
+    FS::remove(file);
+  FS::removeRecursive(dir);
+}
@@ -0,0 +1,87 @@
+#include "helper.hpp"
+
+#include <blake3.hpp>
+
+#include <chrono>
+
+static const char *M = "[blake3]";
+
+static std::string testInput(const size_t size)
+{
+  // same input pattern as the official test vectors
+  std::string input(size, '\0');
+  for(size_t i = 0; i < size; ++i)
+    input[i] = static_cast<char>(i % 251);
+  return input;
+}
+
+static std::string hashHex(const std::string &data, const size_t chunkSize = 0)
+{
+  BLAKE3 hash;
+
+  if(chunkSize) {
+    for(size_t i = 0; i < data.size(); i += chunkSize)
+      hash.addData(&data[i], std::min(chunkSize, data.size() - i));
+  }
+  else
+    hash.addData(data.data(), data.size());
+
+  unsigned char digest[BLAKE3::DIGEST_SIZE];
+  hash.getHash(digest);
+
+  static const char hex[] = "0123456789abcdef";
+  std::string out;
+  for(const unsigned char byte : digest) {
+    out += hex[byte >> 4];
+    out += hex[byte & 0xf];
+  }
+  return out;
+}
+
+TEST_CASE("blake3 test vectors", M) {
+  const std::pair<size_t, const char *> vectors[] {
+    {0,      "af1349b9f5f9a1a6a0404dea36dcc9499bcb25c9adc112b7cc9a93cae41f3262"},
+    {1,      "2d3adedff11b61f14c886e35afa036736dcd87a74d27b5c1510225d0f592e213"},
+    {1023,   "10108970eeda3eb932baac1428c7a2163b0e924c9a9e25b35bba72b28f70bd11"},
+    {1024,   "42214739f095a406f3fc83deb889744ac00df831c10daa55189b5d121c855af7"},
+    {1025,   "d00278ae47eb27b34faecf67b4fe263f82d5412916c1ffd97c8cb7fb814b8444"},
+    {2048,   "e776b6028c7cd22a4d0ba182a8bf62205d2ef576467e838ed6f2529b85fba24a"},
+    {2049,   "5f4d72f40d7a5f82b15ca2b2e44b1de3c2ef86c426c95c1af0b6879522563030"},
+    {3072,   "b98cb0ff3623be03326b373de6b9095218513e64f1ee2edd2525c7ad1e5cffd2"},
+    {31744,  "62b6960e1a44bcc1eb1a611a8d6235b6b4b78f32e7abc4fb4c6cdcce94895c47"},
+    {102400, "bc3e3d41a1146b069abffad3c0d44860cf664390afce4d9661f7902e7943e085"},
+  };
+
+  for(const auto &[size, expected] : vectors) {
+    INFO(size << " bytes");
+    const std::string input = testInput(size);
+
+    REQUIRE(hashHex(input) == expected);
+    REQUIRE(hashHex(input, 1) == expected);
+    REQUIRE(hashHex(input, 100) == expected);
+    REQUIRE(hashHex(input, 4096) == expected);
+  }
+}
+
+TEST_CASE("blake3 multithreaded tree hashing", M) {
+  const std::string input = testInput(8 * 1024 * 1024 + 3);
+  const char *expected =
+    "b48b4c951537fc5d5923170dcac39102472d2638371a62891093593a9a4ca1b8";
+
+  REQUIRE(hashHex(input) == expected);
+  REQUIRE(hashHex(input, 3 * 1024 * 1024) == expected);
+}
+
+TEST_CASE("blake3 hash 256 MB", "[blake3][.benchmark]") {
+  const std::string input = testInput(256 * 1024 * 1024);
+
+  for(const size_t chunkSize : {64 * 1024, 4 * 1024 * 1024, 0}) {
+    const auto start = std::chrono::steady_clock::now();
+    hashHex(input, chunkSize);
+    const std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+    WARN("reading " << (chunkSize ? chunkSize : input.size()) << " bytes at a time: "
+      << elapsed.count() << " ms");
+  }
+}
@@ -0,0 +1,134 @@
+#include "helper.hpp"
+
+#include <config.hpp>
+#include <filesystem.hpp>
+#include <win32.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+static const char *M = "[config]";
+static const Path CONFIG_PATH("test/config.ini");
+
+// returns the contents as UTF-8 with \n line endings on every platform
+static std::string readFile(const Path &path)
+{
+  std::ifstream file;
+  FS::open(file, path);
+
+  std::ostringstream contents;
+  contents << file.rdbuf();
+  std::string text = contents.str();
+
+#ifdef _WIN32
+  if(text.size() >= 2 && text[0] == '\xFF' && text[1] == '\xFE') {
+    const std::wstring wide(reinterpret_cast<const wchar_t *>(text.data() + 2),
+      (text.size() - 2) / sizeof(wchar_t));
+    text = Win32::narrow(wide);
+  }
+
+  text.erase(std::remove(text.begin(), text.end(), '\r'), text.end());
+#endif
+
+  return text;
+}
+
+TEST_CASE("create the configuration file on first run", M) {
+  FS::remove(CONFIG_PATH);
+
+  {
+    Config config(CONFIG_PATH);
+    REQUIRE(config.isFirstRun());
+    REQUIRE(config.remotes.hasName("ReaPack"));
+  }
+
+  REQUIRE(FS::exists(CONFIG_PATH));
+
+  {
+    Config config(CONFIG_PATH);
+    REQUIRE_FALSE(config.isFirstRun());
+    REQUIRE(config.remotes.hasName("ReaPack"));
+    REQUIRE(config.remotes.hasName("ReaTeam Scripts"));
+  }
+
+  FS::remove(CONFIG_PATH);
+}
+
+TEST_CASE("read configuration values", M) {
+  FS::write(CONFIG_PATH,
+    "[general]\nversion=4\n"
+    "; comment\n"
+    "[Network]\n"
+    "  Proxy = \"localhost:8080\"  \n"
+    "verifypeer=0\n"
+    "[archive]\ncompression=2\n"
+    "[remotes]\nsize=1\nremote0=Hello|https://foo.bar/index.xml|1|2\n"
+  );
+
+  {
+    Config config(CONFIG_PATH);
+    REQUIRE(config.network.proxy == "localhost:8080");
+    REQUIRE_FALSE(config.network.verifyPeer);
+    REQUIRE(config.network.staleThreshold == NetworkOpts::OneWeekThreshold);
+    REQUIRE(config.archive.compression == ArchiveOpts::SmallCompression);
+    REQUIRE(config.remotes.get("Hello").url() == "https://foo.bar/index.xml");
+  }
+
+  FS::remove(CONFIG_PATH);
+}
+
+TEST_CASE("keep unknown configuration keys", M) {
+  FS::write(CONFIG_PATH, "[general]\nversion=4\n[custom]\nkey=value\n");
+
+  {
+    Config config(CONFIG_PATH);
+    config.network.proxy = "localhost";
+    config.write();
+  }
+
+  const std::string &contents = readFile(CONFIG_PATH);
+  REQUIRE(contents.find("[custom]\nkey=value\n") != std::string::npos);
+  REQUIRE(contents.find("proxy=localhost\n") != std::string::npos);
+
+  FS::remove(CONFIG_PATH);
+}
+
+TEST_CASE("remove leftover remote entries", M) {
+  FS::write(CONFIG_PATH,
+    "[general]\nversion=4\n"
+    "[remotes]\nsize=2\n"
+    "remote0=Hello|https://foo.bar/index.xml|1|2\n"
+    "remote1=World|https://foo.bar/index.xml|1|2\n"
+  );
+
+  {
+    Config config(CONFIG_PATH);
+    config.remotes.remove("Hello");
+    config.remotes.remove("World");
+  }
+
+  const std::string &contents = readFile(CONFIG_PATH);
+  REQUIRE(contents.find("remote0=ReaPack|") != std::string::npos);
+  REQUIRE(contents.find("remote1=") == std::string::npos);
+  REQUIRE(contents.find("size=1\n") != std::string::npos);
+
+  FS::remove(CONFIG_PATH);
+}
+
+TEST_CASE("don't rewrite an unchanged configuration file", M) {
+  FS::remove(CONFIG_PATH);
+  { Config config(CONFIG_PATH); }
+
+  const std::string &original = readFile(CONFIG_PATH) + "; comment\n";
+  FS::write(CONFIG_PATH, original);
+
+  {
+    Config config(CONFIG_PATH);
+    config.write();
+  }
+
+  REQUIRE(readFile(CONFIG_PATH) == original);
+
+  FS::remove(CONFIG_PATH);
+}
@@ -2,6 +2,8 @@
 
 #include <event.hpp>
 
+#include <thread>
+
 #include <reaper_plugin_functions.h>
 
 constexpr const char *M = "[event]";
@@ -127,7 +129,7 @@ TEST_CASE("AsyncEvent<void(...)> sets the future's value", M) {
   AsyncEvent<void()> e;
   e >> []{};
 
-  std::future<void> ret = e();
+  std::future<void> ret = e.future();
 
   REQUIRE(ret.wait_for(std::chrono::seconds(0)) == std::future_status::timeout);
   tick();
@@ -142,7 +144,7 @@ TEST_CASE("AsyncEvent<R(...)> sets the future's value", M) {
   e >> []{ return "hello world"; }
     >> []{ return "foo bar"; };
 
-  std::future<std::optional<std::string>> ret = e();
+  std::future<std::optional<std::string>> ret = e.future();
 
   REQUIRE(ret.wait_for(std::chrono::seconds(0)) == std::future_status::timeout);
   tick();
@@ -159,8 +161,8 @@ TEST_CASE("running an AsyncEvent without handlers returns synchronously", M) {
   AsyncEvent<void()> e1;
   AsyncEvent<int()> e2;
 
-  auto r1 = e1();
-  auto r2 = e2();
+  auto r1 = e1.future();
+  auto r2 = e2.future();
 
   REQUIRE(r1.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
   REQUIRE_FALSE(r2.get().has_value());
@@ -206,12 +208,29 @@ TEST_CASE("deleted not-yet-posted AsyncEvents are discarded", M) {
 
   {
     AsyncEvent<void()> e;
+    e >> [] { FAIL("handler of a deleted event was run"); };
     e();
   }
 
   tick();
 }
 
+TEST_CASE("AsyncEvents posted before being deleted by a handler are discarded", M) {
+  static void (*tick)() = nullptr;
+  plugin_register = [](const char *, void *c) { tick = (void(*)())c; return 0; };
+
+  AsyncEvent<void()> keepTimerAlive;
+
+  int count = 0;
+  auto e = new AsyncEvent<void()>();
+  *e >> [&] { ++count; delete e; };
+  (*e)();
+  (*e)();
+
+  tick();
+  REQUIRE(count == 1);
+}
+
 TEST_CASE("deleting AsyncEvent from handler is safe", M) {
   static void (*tick)() = nullptr;
   plugin_register = [](const char *, void *c) { tick = (void(*)())c; return 0; };
@@ -222,3 +241,36 @@ TEST_CASE("deleting AsyncEvent from handler is safe", M) {
 
   tick();
 }
+
+TEST_CASE("post 100k AsyncEvents from worker threads", "[event][.benchmark]") {
+  static void (*tick)() = nullptr;
+  plugin_register = [](const char *, void *c) { tick = (void(*)())c; return 0; };
+
+  constexpr size_t THREADS = 4, EVENTS = 100'000;
+
+  size_t count = 0;
+  AsyncEvent<void()> e;
+  e >> [&] { ++count; };
+
+  const auto start = std::chrono::steady_clock::now();
+
+  std::vector<std::thread> threads;
+  for(size_t i = 0; i < THREADS; ++i) {
+    threads.emplace_back([&] {
+      for(size_t j = 0; j < EVENTS / THREADS; ++j)
+        e();
+    });
+  }
+
+  while(count < EVENTS)
+    tick();
+
+  for(std::thread &thread : threads)
+    thread.join();
+
+  const std::chrono::duration<double, std::milli> elapsed =
+    std::chrono::steady_clock::now() - start;
+  WARN(EVENTS << " events dispatched in " << elapsed.count() << " ms");
+
+  REQUIRE(count == EVENTS);
+}
@@ -3,6 +3,8 @@
 #include <filesystem.hpp>
 #include <index.hpp>
 
+#include <list>
+
 static const char *M = "[filesystem]";
 static const Path RIPATH("test/indexes");
 
@@ -57,3 +59,14 @@ TEST_CASE("all files exists", M) {
   REQUIRE_FALSE(FS::allExists(std::vector<std::string>{"ReaPack"})); // directory
   REQUIRE(FS::allExists(std::vector<std::string>{"ReaPack"}, true));
 }
+
+TEST_CASE("directory listing cache", M) {
+  UseRootPath root(RIPATH);
+  FS::DirCache cache;
+
+  REQUIRE(cache.exists(Index::pathFor("Новая папка")));
+  REQUIRE(cache.exists(Index::pathFor("future_version")));
+  REQUIRE_FALSE(cache.exists(Index::pathFor("not_found")));
+  REQUIRE_FALSE(cache.exists(Path("ReaPack"))); // directory
+  REQUIRE_FALSE(cache.exists(Path("not_found/file")));
+}
@@ -2,6 +2,9 @@
 
 #include <filter.hpp>
 
+#include <chrono>
+#include <random>
+
 using namespace std;
 
 static const char *M = "[filter]";
@@ -323,3 +326,89 @@ TEST_CASE("AND grouping", M) {
     REQUIRE_FALSE(f.match({"bacon"}));
   }
 }
+
+TEST_CASE("unicode case folding", M) {
+  Filter f("привет");
+
+  REQUIRE(f.match({"ПРИВЕТ мир"}));
+  REQUIRE_FALSE(f.match({"пока"}));
+}
+
+TEST_CASE("match pre-folded text", M) {
+  const Filter::Text text({"Hello World", "Chunky Bacon"});
+
+  REQUIRE(Filter("hello bacon").match(text));
+  REQUIRE(Filter("^chunky").match(text));
+  REQUIRE(Filter("world$").match(text));
+  REQUIRE(Filter("'world chunky'").match(Filter::Text({"world chunky"})));
+  REQUIRE_FALSE(Filter("'world chunky'").match(text)); // not across values
+  REQUIRE_FALSE(Filter("NOT bacon").match(text));
+  REQUIRE_FALSE(Filter("NOT bacon").match(Filter::Text({})));
+}
+
+TEST_CASE("later occurrences", M) {
+  REQUIRE(Filter("'word'").match({"wordy word"}));
+  REQUIRE(Filter("hello$").match({"hello hello"}));
+}
+
+TEST_CASE("filter refinement", M) {
+  const auto implies = [](const char *a, const char *b) {
+    return Filter(a).implies(Filter(b));
+  };
+
+  REQUIRE(implies("hello", ""));
+  REQUIRE(implies("hello", "hello"));
+  REQUIRE(implies("hello", "hell"));
+  REQUIRE(implies("hello", "ello"));
+  REQUIRE(implies("hello w", "hello"));
+  REQUIRE(implies("world hello", "hello"));
+  REQUIRE(implies("^hello", "^hell"));
+  REQUIRE(implies("hello$", "llo$"));
+  REQUIRE(implies("'hello'", "hell"));
+  REQUIRE(implies("NOT bacon hello", "NOT bacon"));
+  REQUIRE(implies("( a OR b ) c", "( a OR b )"));
+
+  REQUIRE_FALSE(implies("", "hello"));
+  REQUIRE_FALSE(implies("hell", "hello"));
+  REQUIRE_FALSE(implies("hello", "^hell"));
+  REQUIRE_FALSE(implies("^hello", "llo$"));
+  REQUIRE_FALSE(implies("^abab$", "^ab$"));
+  REQUIRE_FALSE(implies("'hello'", "'hell'"));
+  REQUIRE_FALSE(implies("NOT bacons", "NOT bacon"));
+  REQUIRE_FALSE(implies("hello OR", "hello"));
+  REQUIRE_FALSE(implies("hello OR w", "hello"));
+}
+
+TEST_CASE("required terms", M) {
+  REQUIRE(Filter().requiredTerms().empty());
+  REQUIRE(Filter("Hello ^World 'x y'").requiredTerms() ==
+    vector<string>{"hello", "world", "x y"});
+  REQUIRE(Filter("a NOT b ( c d ) e OR f").requiredTerms() ==
+    vector<string>{"a"});
+}
+
+TEST_CASE("filter 50000 rows", "[filter][.benchmark]") {
+  mt19937 rng(1);
+  const auto randomWord = [&] {
+    string word(3 + rng() % 8, '\0');
+    for(char &c : word)
+      c = static_cast<char>('a' + rng() % 26);
+    return word;
+  };
+
+  vector<Filter::Text> rows;
+  for(int i = 0; i < 50000; ++i)
+    rows.emplace_back(vector<string>{randomWord() + " " + randomWord(),
+      randomWord() + " " + randomWord() + " " + randomWord()});
+
+  const Filter filter("abc OR ( NOT xyz 'the' )");
+  size_t matches = 0;
+
+  const auto start = chrono::steady_clock::now();
+  for(const Filter::Text &row : rows)
+    matches += filter.match(row);
+  const chrono::duration<double, milli> elapsed =
+    chrono::steady_clock::now() - start;
+
+  WARN(matches << " matches in " << elapsed.count() << " ms");
+}
@@ -1,6 +1,8 @@
 #include "helper.hpp"
 
+#include <filesystem.hpp>
 #include <hash.hpp>
+#include <path.hpp>
 
 static const char *M = "[hash]";
 
@@ -30,6 +32,35 @@ TEST_CASE("sha256 hashes", M) {
   }
 }
 
+TEST_CASE("blake3 hashes", M) {
+  Hash hash(Hash::BLAKE3);
+
+  SECTION("empty")
+    REQUIRE(hash.digest() ==
+      "1e20af1349b9f5f9a1a6a0404dea36dcc9499bcb25c9adc112b7cc9a93cae41f3262");
+
+  SECTION("split chunks") {
+    hash.addData("hello", 5);
+    hash.addData(" world", 6);
+
+    REQUIRE(hash.digest() ==
+      "1e20d74981efa70a0c880b8d8c1985d075dbcbf679b99a5f9914e5aaf96b831a9e24");
+  }
+}
+
+TEST_CASE("hash many buffers at once", M) {
+  const std::vector<std::string_view> buffers{"", "hello world", "foo bar baz"};
+  const auto digests = Hash::digestMany(Hash::SHA256, buffers);
+
+  REQUIRE(digests.size() == buffers.size());
+
+  for(size_t i = 0; i < buffers.size(); ++i) {
+    Hash hash(Hash::SHA256);
+    hash.addData(buffers[i].data(), buffers[i].size());
+    REQUIRE(digests[i] == hash.digest());
+  }
+}
+
 TEST_CASE("invalid algorithm", M) {
   Hash hash(static_cast<Hash::Algorithm>(0));
   hash.addData("foo bar", 7);
@@ -52,4 +83,33 @@ TEST_CASE("get hash algorithm", M) {
     REQUIRE(Hash::getAlgorithm("1202abcd", &algo));
     REQUIRE(algo == Hash::SHA256);
   }
+
+  SECTION("blake3") {
+    REQUIRE(Hash::getAlgorithm("1e02abcd", &algo));
+    REQUIRE(algo == Hash::BLAKE3);
+  }
+}
+
+TEST_CASE("verify the checksum of a file", M) {
+  const Path path("test/hash_file");
+  FS::write(path, "hello world");
+
+  REQUIRE(Hash::verify(path,
+    "1220b94d27b9934d3e08a52e52d7da7dabfac484efe37a5380ee9088f7ace2efcde9"));
+
+  std::string checksum;
+  REQUIRE(Hash::fromFile(path, Hash::SHA256, &checksum));
+  REQUIRE(checksum ==
+    "1220b94d27b9934d3e08a52e52d7da7dabfac484efe37a5380ee9088f7ace2efcde9");
+
+  REQUIRE_FALSE(Hash::verify(path,
+    "1220dbd318c1c462aee872f41109a4dfd3048871a03dedd0fe0e757ced57dad6f2d7"));
+  REQUIRE_FALSE(Hash::verify(path, "garbage"));
+
+  REQUIRE(Hash::verify(path,
+    "1e20d74981efa70a0c880b8d8c1985d075dbcbf679b99a5f9914e5aaf96b831a9e24"));
+
+  FS::remove(path);
+  REQUIRE_FALSE(Hash::verify(path,
+    "1220b94d27b9934d3e08a52e52d7da7dabfac484efe37a5380ee9088f7ace2efcde9"));
 }
@@ -0,0 +1,80 @@
+#include "helper.hpp"
+
+#include <errors.hpp>
+#include <filesystem.hpp>
+#include <index.hpp>
+#include <indexcache.hpp>
+
+#include <cstring>
+
+static const char *M = "[indexcache]";
+static const Path RIPATH("test/indexes");
+
+static const char *INDEX = "<index version=\"1\"/>\n";
+
+TEST_CASE("share loaded indexes", M) {
+  UseRootPath root(RIPATH);
+  FS::write(Index::pathFor("cached"), INDEX);
+
+  IndexCache cache;
+  const IndexPtr &index = cache.load("cached");
+  REQUIRE(index->name() == "cached");
+  REQUIRE(cache.load("cached") == index);
+  REQUIRE(cache.size() == 1);
+  REQUIRE(cache.usage() == strlen(INDEX));
+
+  SECTION("invalidate") {
+    cache.invalidate("cached");
+    REQUIRE(cache.size() == 0);
+    REQUIRE(cache.usage() == 0);
+    REQUIRE(cache.load("cached") != index);
+  }
+
+  SECTION("file changed") {
+    FS::write(Index::pathFor("cached"), "<index version=\"1\"></index>\n");
+    REQUIRE(cache.load("cached") != index);
+    REQUIRE(cache.size() == 1);
+  }
+
+  SECTION("clear") {
+    cache.clear();
+    REQUIRE(cache.size() == 0);
+    REQUIRE(cache.load("cached") != index);
+  }
+
+  FS::remove(Index::pathFor("cached"));
+}
+
+TEST_CASE("evict least recently used indexes", M) {
+  UseRootPath root(RIPATH);
+
+  const char *names[] = {"cached1", "cached2", "cached3"};
+  for(const char *name : names)
+    FS::write(Index::pathFor(name), INDEX);
+
+  IndexCache cache(strlen(INDEX) * 2);
+  const IndexPtr &first = cache.load("cached1");
+  cache.load("cached2");
+  REQUIRE(cache.load("cached1") == first); // now the most recently used
+  cache.load("cached3");
+
+  REQUIRE(cache.size() == 2);
+  REQUIRE(cache.load("cached1") == first);
+
+  SECTION("lower budget") {
+    cache.setBudget(0);
+    REQUIRE(cache.size() == 1);
+    REQUIRE(cache.load("cached1") == first);
+  }
+
+  for(const char *name : names)
+    FS::remove(Index::pathFor(name));
+}
+
+TEST_CASE("cache missing index", M) {
+  UseRootPath root(RIPATH);
+
+  IndexCache cache;
+  REQUIRE_THROWS_AS(cache.load("404"), reapack_error);
+  REQUIRE(cache.size() == 0);
+}
@@ -0,0 +1,133 @@
+#include "helper.hpp"
+
+#include <filesystem.hpp>
+#include <journal.hpp>
+
+static const char *M = "[journal]";
+static const Path JOURNAL_PATH("test/journal.txt");
+
+static const char *CHECKSUM =
+  "1220b94d27b9934d3e08a52e52d7da7dabfac484efe37a5380ee9088f7ace2efcde9";
+
+TEST_CASE("record completed temporary files", M) {
+  const TempPath file(Path("test/journal_file"));
+  FS::write(file.temp(), "hello world");
+
+  {
+    Journal journal(JOURNAL_PATH);
+    REQUIRE_FALSE(journal.contains(file));
+
+    journal.add(file, CHECKSUM);
+    REQUIRE(journal.contains(file));
+    REQUIRE(journal.contains(file, CHECKSUM));
+    REQUIRE_FALSE(journal.contains(file, "1220"));
+  }
+
+  // written immediately, without waiting for save()
+  {
+    Journal journal(JOURNAL_PATH);
+    REQUIRE(journal.contains(file, CHECKSUM));
+
+    journal.remove(file);
+    REQUIRE_FALSE(journal.contains(file));
+
+    journal.save();
+  }
+
+  REQUIRE_FALSE(FS::exists(JOURNAL_PATH));
+  FS::remove(file.temp());
+}
+
+TEST_CASE("don't record files without checksum", M) {
+  const TempPath file(Path("test/journal_file"));
+
+  Journal journal(JOURNAL_PATH);
+  journal.add(file, {});
+  REQUIRE_FALSE(journal.contains(file));
+  REQUIRE_FALSE(FS::exists(JOURNAL_PATH));
+}
+
+TEST_CASE("forget deleted temporary files", M) {
+  const TempPath file(Path("test/journal_file"));
+  FS::write(file.temp(), "hello world");
+
+  {
+    Journal journal(JOURNAL_PATH);
+    journal.add(file, CHECKSUM);
+  }
+
+  FS::remove(file.temp());
+
+  Journal journal(JOURNAL_PATH);
+  REQUIRE_FALSE(journal.contains(file));
+
+  journal.save();
+  REQUIRE_FALSE(FS::exists(JOURNAL_PATH));
+}
+
+TEST_CASE("ignore corrupted journal entries", M) {
+  const TempPath file(Path("test/journal_file"));
+  FS::write(file.temp(), "hello world");
+
+  FS::write(JOURNAL_PATH, std::string{} +
+    "garbage\n"
+    "1220\ttest/journal_file.part\n"
+    "\t\n" +
+    CHECKSUM + "\ttest/journal_file.part\n" +
+    CHECKSUM + "\ttest/journal_fi"
+  );
+
+  {
+    Journal journal(JOURNAL_PATH);
+    REQUIRE(journal.contains(file, CHECKSUM));
+    REQUIRE_FALSE(journal.contains(TempPath(Path("test/journal_fi"))));
+    journal.save();
+  }
+
+  REQUIRE(FS::exists(JOURNAL_PATH));
+
+  FS::remove(JOURNAL_PATH);
+  FS::remove(file.temp());
+}
+
+TEST_CASE("expire temporary files left unused", M) {
+  const TempPath used(Path("test/journal_used")), unused(Path("test/journal_unused"));
+  FS::write(used.temp(), "hello world");
+  FS::write(unused.temp(), "hello world");
+
+  {
+    Journal journal(JOURNAL_PATH);
+    journal.add(used, CHECKSUM);
+    journal.add(unused, CHECKSUM);
+    journal.save();
+  }
+
+  for(unsigned int i = 0; i < Journal::MAX_UNUSED_TRANSACTIONS; ++i) {
+    Journal journal(JOURNAL_PATH);
+    REQUIRE(journal.contains(unused, CHECKSUM));
+    journal.add(used, CHECKSUM); // reused by this transaction
+    journal.save();
+  }
+
+  REQUIRE(FS::exists(unused.temp()));
+
+  {
+    Journal journal(JOURNAL_PATH);
+    journal.add(used, CHECKSUM);
+    journal.save();
+  }
+
+  REQUIRE_FALSE(FS::exists(unused.temp()));
+  REQUIRE(FS::exists(used.temp()));
+
+  {
+    Journal journal(JOURNAL_PATH);
+    REQUIRE_FALSE(journal.contains(unused));
+    REQUIRE(journal.contains(used, CHECKSUM));
+    journal.remove(used);
+    journal.save();
+  }
+
+  REQUIRE_FALSE(FS::exists(JOURNAL_PATH));
+  FS::remove(used.temp());
+}
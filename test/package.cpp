@@ -228,6 +228,49 @@ TEST_CASE("find matching version", M) {
   REQUIRE(pack.findVersion({"2"}) == nullptr);
 }
 
+TEST_CASE("find equivalent version name", M) {
+  Index ri("Remote Name");
+  Category cat("Category Name", &ri);
+  Package pack(Package::ScriptType, "a", &cat);
+
+  Version *ver = new Version("1.0", &pack);
+  ver->addSource(new Source({}, "google.com", ver));
+  pack.addVersion(ver);
+
+  REQUIRE(pack.findVersion({"1.0"}) == ver);
+  REQUIRE(pack.findVersion({"1"}) == ver);
+  REQUIRE(pack.findVersion({"1.0.0"}) == ver);
+  REQUIRE(pack.findVersion({"1.0.1"}) == nullptr);
+}
+
+TEST_CASE("versions added out of order", M) {
+  Index ri("Remote Name");
+  Category cat("Category Name", &ri);
+  Package pack(Package::ScriptType, "a", &cat);
+
+  const char *names[] = {"1.1", "2.0beta", "0.9", "1.0", "1.2alpha"};
+  const Version *vers[5];
+
+  for(size_t i = 0; i < 5; ++i) {
+    Version *ver = new Version(names[i], &pack);
+    ver->addSource(new Source({}, "google.com", ver));
+    pack.addVersion(ver);
+    vers[i] = ver;
+  }
+
+  REQUIRE(pack.version(0) == vers[2]);
+  REQUIRE(pack.version(1) == vers[3]);
+  REQUIRE(pack.version(2) == vers[0]);
+  REQUIRE(pack.version(3) == vers[4]);
+  REQUIRE(pack.version(4) == vers[1]);
+
+  REQUIRE(pack.lastVersion() == vers[1]);
+  REQUIRE(pack.lastVersion(false) == vers[0]);
+  REQUIRE(pack.lastVersion(false, {"1.2alpha"}) == vers[1]);
+  REQUIRE(pack.lastVersion(false, {"1.1"}) == vers[0]);
+  REQUIRE(pack.lastVersion(false, {"1.2"}) == nullptr);
+}
+
 TEST_CASE("package full name", M) {
   const Index ri("Index Name");
   const Category cat("Category Name", &ri);
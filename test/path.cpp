@@ -19,6 +19,38 @@ TEST_CASE("compare paths", M) {
   REQUIRE_FALSE(a != a);
 }
 
+TEST_CASE("order paths segment by segment", M) {
+  REQUIRE(Path("a/b") < Path("a-b"));
+  REQUIRE(Path("a") < Path("a/b"));
+  REQUIRE(Path("a/b") < Path("a/c"));
+  REQUIRE(Path("a/bc") < Path("ab/c"));
+  REQUIRE_FALSE(Path("a/b") < Path("a/b"));
+  REQUIRE_FALSE(Path("b") < Path("a/z"));
+}
+
+TEST_CASE("iterate over path segments", M) {
+  const Path path("hello/chunky/bacon");
+
+  std::vector<string> segments;
+  for(const string_view &segment : path)
+    segments.emplace_back(segment);
+
+  REQUIRE(segments == std::vector<string>{"hello", "chunky", "bacon"});
+
+  const Path empty;
+  REQUIRE(empty.begin() == empty.end());
+}
+
+TEST_CASE("hash paths", M) {
+  const std::hash<Path> hash;
+
+  REQUIRE(hash(Path("a/b")) == hash(Path("a\\b")));
+  REQUIRE(hash(Path("a/b")) != hash(Path("a/c")));
+#ifndef _WIN32
+  REQUIRE(hash(Path("/a/b")) != hash(Path("a/b")));
+#endif
+}
+
 TEST_CASE("append path segments", M) {
   Path path;
   REQUIRE(path.empty());
@@ -198,6 +230,20 @@ TEST_CASE("absolute path (root only)", M) {
 #endif
 }
 
+TEST_CASE("dirname of an absolute path", M) {
+#ifdef _WIN32
+  const Path a("C:\\Windows");
+  const Path root("C:");
+#else
+  const Path a("/usr");
+  const Path root("/");
+#endif
+
+  REQUIRE(a.dirname().absolute());
+  CHECK(a.dirname() == root);
+  CHECK(a.dirname().join() == root.join());
+}
+
 TEST_CASE("append absolute path to empty path", M) {
 #ifdef _WIN32
   const Path abs("C:\\Windows\\");
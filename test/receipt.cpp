@@ -29,6 +29,12 @@ TEST_CASE("non-empty receipt", M) {
   SECTION("export")
     r.addExport(Path("hello/world"));
 
+  SECTION("verification")
+    r.setVerified();
+
+  SECTION("mismatch")
+    r.addMismatch(Path("hello/world"), false);
+
   SECTION("error")
     r.addError({"message", "context"});
 
@@ -65,6 +71,12 @@ TEST_CASE("set receipt flags", M) {
     expected = Receipt::ExportedFlag;
   }
 
+  SECTION("mismatch") {
+    r.addMismatch(Path("hello/world"), true);
+    CHECK_FALSE(r.test(Receipt::InstalledOrRemoved));
+    expected = Receipt::VerifiedFlag;
+  }
+
   SECTION("error") {
     r.addError({"message", "context"});
     CHECK_FALSE(r.test(Receipt::PackageChangedFlag));
@@ -236,3 +248,14 @@ TEST_CASE("sort InstallTickets (case insensitive)", M) {
   // duplicates should still be preserved
   REQUIRE(page.find(pkg1.name()) < page.rfind(pkg1.name()));
 }
+
+TEST_CASE("list modified files", M) {
+  Receipt r;
+  r.addMismatch(Path("Scripts/b.lua"), true);
+  r.addMismatch(Path("Scripts/a.lua"), false);
+
+  const ReceiptPage &page = r.mismatchPage();
+  REQUIRE(page.title() == "Modified (2)");
+  REQUIRE(page.contents() ==
+    "Scripts/a.lua [modified]\r\nScripts/b.lua [missing]");
+}
@@ -92,6 +92,24 @@ TEST_CASE("get file list", M) {
   REQUIRE(files[0].path == src->targetPath());
   REQUIRE(files[0].sections == 0);
   REQUIRE(files[0].type == pkg.type());
+  REQUIRE(files[0].checksum.empty());
+}
+
+TEST_CASE("record file checksum", M) {
+  MAKE_PACKAGE
+
+  Registry reg;
+  reg.push(&ver);
+  reg.setChecksum(src->targetPath(), "1220abcd", 42);
+
+  const vector<Registry::File> &files = reg.getFiles(reg.getEntry(&pkg));
+  REQUIRE(files.size() == 1);
+  REQUIRE(files[0].checksum == "1220abcd");
+  REQUIRE(files[0].size == 42);
+
+  // reinstalling clears it until the new file is recorded
+  reg.push(&ver);
+  REQUIRE(reg.getFiles(reg.getEntry(&pkg))[0].checksum.empty());
 }
 
 TEST_CASE("query all packages", M) {
@@ -115,6 +133,29 @@ TEST_CASE("query all packages", M) {
   REQUIRE(entries[0].author == "John Doe");
 }
 
+TEST_CASE("query packages from every repository", M) {
+  MAKE_PACKAGE
+
+  Index other("Other Remote");
+  Category otherCat("Category Name", &other);
+  Package otherPkg(Package::ScriptType, "World", &otherCat);
+  Version otherVer("1.0", &otherPkg);
+  otherVer.addSource(new Source("other file", "url", &otherVer));
+
+  Registry reg;
+  REQUIRE(reg.getEntries().empty());
+
+  reg.push(&ver);
+  reg.push(&otherVer);
+
+  const vector<Registry::Entry> &entries = reg.getEntries();
+  REQUIRE(entries.size() == 2);
+  REQUIRE(entries[0].remote == "Other Remote");
+  REQUIRE(entries[0].package == "World");
+  REQUIRE(entries[1].remote == "Remote Name");
+  REQUIRE(entries[1].package == "Hello");
+}
+
 TEST_CASE("forget registry entry", M) {
   MAKE_PACKAGE
 
@@ -0,0 +1,132 @@
+#include "helper.hpp"
+
+#include <index.hpp>
+#include <searchindex.hpp>
+
+#include <chrono>
+#include <random>
+
+using namespace std;
+
+static const char *M = "[searchindex]";
+
+static IndexPtr makeIndex()
+{
+  return Index::load("Test Repo", R"(
+<index version="1">
+  <category name="Editing">
+    <reapack name="split.lua" type="script" desc="Split items at cursor">
+      <version name="1.0" author="Jane Doe"><source>http://x</source></version>
+      <version name="2.0" author="Renée"><source>http://x</source></version>
+    </reapack>
+    <reapack name="glue.lua" type="script">
+      <version name="1.0"><source>http://x</source></version>
+    </reapack>
+  </category>
+  <category name="Items">
+    <reapack name="Split" type="script">
+      <version name="1.0" author="John"><source>http://x</source></version>
+    </reapack>
+  </category>
+</index>
+)");
+}
+
+static vector<string> names(const vector<SearchIndex::Result> &results)
+{
+  vector<string> list;
+  for(const SearchIndex::Result &result : results)
+    list.push_back(result.package->name());
+  return list;
+}
+
+TEST_CASE("search index candidates", M) {
+  const IndexPtr &ri = makeIndex();
+  const SearchIndex &search = ri->searchIndex();
+
+  REQUIRE(search.size() == 3);
+  REQUIRE(&search == &ri->searchIndex()); // built only once
+
+  REQUIRE(search.candidates({}) == vector<SearchIndex::DocId>{0, 1, 2});
+  REQUIRE(search.candidates({"split"}) == vector<SearchIndex::DocId>{0, 2});
+  REQUIRE(search.candidates({"split", "cursor"}) == vector<SearchIndex::DocId>{0});
+  REQUIRE(search.candidates({"items"}) == vector<SearchIndex::DocId>{0, 2});
+  REQUIRE(search.candidates({"renée"}) == vector<SearchIndex::DocId>{0});
+  REQUIRE(search.candidates({"unknown"}) == vector<SearchIndex::DocId>{1});
+  REQUIRE(search.candidates({"xyz"}).empty());
+  REQUIRE(search.candidates({"gl"}).size() == 3); // too short to be indexed
+  REQUIRE(search.candidates({"repo"}).size() == 3); // repository name
+}
+
+TEST_CASE("ranked search", M) {
+  const IndexPtr &ri = makeIndex();
+  const SearchIndex &search = ri->searchIndex();
+
+  SECTION("exact name first") {
+    REQUIRE(names(search.search("split")) ==
+      vector<string>{"Split", "split.lua"});
+  }
+
+  SECTION("case-insensitive") {
+    REQUIRE(names(search.search("SPLIT CURSOR")) == vector<string>{"split.lua"});
+    REQUIRE(names(search.search("RENÉE")) == vector<string>{"split.lua"});
+  }
+
+  SECTION("all words must match") {
+    REQUIRE(search.search("split glue").empty());
+    REQUIRE(names(search.search("editing gl")) == vector<string>{"glue.lua"});
+  }
+
+  SECTION("limit") {
+    REQUIRE(search.search("lua", 1).size() == 1);
+  }
+
+  SECTION("empty query") {
+    REQUIRE(search.search("  ").empty());
+  }
+}
+
+TEST_CASE("search 100000 packages", "[searchindex][.benchmark]") {
+  mt19937 rng(1);
+  const auto randomWord = [&] {
+    string word(3 + rng() % 8, '\0');
+    for(char &c : word)
+      c = static_cast<char>('a' + rng() % 26);
+    return word;
+  };
+
+  vector<IndexPtr> indexes;
+
+  auto start = chrono::steady_clock::now();
+  for(int r = 0; r < 50; ++r) {
+    string xml = "<index version=\"1\">";
+    for(int c = 0; c < 20; ++c) {
+      xml += "<category name=\"" + randomWord() + "\">";
+      for(int p = 0; p < 100; ++p) {
+        xml += "<reapack name=\"" + randomWord() + ".lua\" type=\"script\" desc=\"" +
+          randomWord() + " " + randomWord() + " " + randomWord() + "\">"
+          "<version name=\"1.0\" author=\"" + randomWord() + "\">"
+          "<source>http://x</source></version></reapack>";
+      }
+      xml += "</category>";
+    }
+    xml += "</index>";
+
+    indexes.push_back(Index::load("repo" + to_string(r), xml.c_str()));
+    indexes.back()->searchIndex();
+  }
+  chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+  WARN("loaded and indexed in " << elapsed.count() << " ms");
+
+  for(const char *query : {"abc", "qwerty", "ab cd", "lua"}) {
+    size_t count = 0;
+
+    start = chrono::steady_clock::now();
+    for(const IndexPtr &ri : indexes)
+      count += ri->searchIndex().search(query).size();
+    elapsed = chrono::steady_clock::now() - start;
+
+    WARN('"' << query << "\": " << count << " results in "
+      << elapsed.count() * 1000 << " us");
+  }
+}
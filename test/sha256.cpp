@@ -0,0 +1,146 @@
+#include "helper.hpp"
+
+#include <sha256.hpp>
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+static const char *M = "[sha256]";
+
+static std::string toHex(const unsigned char *digest)
+{
+  static const char hex[] = "0123456789abcdef";
+  std::string out;
+
+  for(size_t i = 0; i < SHA256::DIGEST_SIZE; ++i) {
+    out += hex[digest[i] >> 4];
+    out += hex[digest[i] & 0xf];
+  }
+
+  return out;
+}
+
+static std::string hashWith(const SHA256::Backend backend,
+  const std::string &data, const size_t chunkSize = 0)
+{
+  SHA256 hash(backend);
+
+  if(chunkSize) {
+    for(size_t i = 0; i < data.size(); i += chunkSize)
+      hash.addData(&data[i], std::min(chunkSize, data.size() - i));
+  }
+  else
+    hash.addData(data.data(), data.size());
+
+  unsigned char digest[SHA256::DIGEST_SIZE];
+  hash.getHash(digest);
+  return toHex(digest);
+}
+
+static std::vector<SHA256::Backend> supportedBackends()
+{
+  std::vector<SHA256::Backend> backends;
+
+  for(const auto backend : {SHA256::Generic, SHA256::AVX2, SHA256::SHANI}) {
+    if(SHA256::isSupported(backend))
+      backends.push_back(backend);
+  }
+
+  return backends;
+}
+
+TEST_CASE("sha256 known vectors", M) {
+  const std::string million(1000000, 'a');
+
+  for(const auto backend : supportedBackends()) {
+    INFO("backend " << backend);
+
+    REQUIRE(hashWith(backend, "") ==
+      "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    REQUIRE(hashWith(backend, "abc") ==
+      "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    REQUIRE(hashWith(backend,
+      "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq") ==
+      "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+    REQUIRE(hashWith(backend, million, 1000) ==
+      "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+    REQUIRE(hashWith(backend, million, 63) == hashWith(backend, million));
+  }
+}
+
+TEST_CASE("sha256 multi-buffer hashing", M) {
+  std::mt19937 rng(42);
+  std::vector<std::string> data(37);
+
+  // cover every padding layout and lanes finishing at different times
+  for(size_t i = 0; i < data.size(); ++i) {
+    data[i].resize(i < 20 ? i * 7 : rng() % 5000);
+    for(char &c : data[i])
+      c = static_cast<char>(rng());
+  }
+
+  const std::vector<std::string_view> views(data.begin(), data.end());
+
+  for(const auto backend : supportedBackends()) {
+    INFO("backend " << backend);
+
+    std::vector<unsigned char> out(views.size() * SHA256::DIGEST_SIZE);
+    SHA256::hashMany(views.data(), views.size(), out.data(), backend);
+
+    for(size_t i = 0; i < views.size(); ++i) {
+      INFO("buffer " << i << " (" << data[i].size() << " bytes)");
+      REQUIRE(toHex(&out[i * SHA256::DIGEST_SIZE]) ==
+        hashWith(SHA256::Generic, data[i]));
+    }
+  }
+}
+
+TEST_CASE("sha256 multi-buffer hashing of partial batches", M) {
+  std::vector<std::string> data(8);
+  for(size_t i = 0; i < data.size(); ++i)
+    data[i].assign(i * 29 + 3, static_cast<char>('a' + i));
+
+  const std::vector<std::string_view> views(data.begin(), data.end());
+
+  for(const auto backend : supportedBackends()) {
+    for(size_t count = 1; count <= views.size(); ++count) {
+      INFO("backend " << backend << ", " << count << " buffers");
+
+      std::vector<unsigned char> out(count * SHA256::DIGEST_SIZE);
+      SHA256::hashMany(views.data(), count, out.data(), backend);
+
+      for(size_t i = 0; i < count; ++i) {
+        REQUIRE(toHex(&out[i * SHA256::DIGEST_SIZE]) ==
+          hashWith(SHA256::Generic, data[i]));
+      }
+    }
+  }
+}
+
+TEST_CASE("hash 10000 small scripts", "[sha256][.benchmark]") {
+  std::mt19937 rng(1);
+  std::vector<std::string> scripts(10000, std::string(2048, '\0'));
+  for(auto &script : scripts) {
+    for(char &c : script)
+      c = static_cast<char>('a' + rng() % 26);
+  }
+
+  const std::vector<std::string_view> views(scripts.begin(), scripts.end());
+  std::vector<unsigned char> out(views.size() * SHA256::DIGEST_SIZE);
+  double baseline = 0;
+
+  for(const auto backend : supportedBackends()) {
+    const auto start = std::chrono::steady_clock::now();
+    for(int i = 0; i < 10; ++i)
+      SHA256::hashMany(views.data(), views.size(), out.data(), backend);
+    const std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+    if(backend == SHA256::Generic)
+      baseline = elapsed.count();
+
+    WARN("backend " << backend << ": " << elapsed.count() / 10 << " ms ("
+      << baseline / elapsed.count() << "x)");
+  }
+}
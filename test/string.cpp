@@ -24,6 +24,16 @@ TEST_CASE("indent string", M) {
   REQUIRE(actual == "  line1\r\n  line2");
 }
 
+TEST_CASE("case folding", M) {
+  REQUIRE(String::fold("Hello World 123") == "hello world 123");
+  REQUIRE(String::fold("ÀÉÎÕÜ ÆÇ ×") == "àéîõü æç ×");
+  REQUIRE(String::fold("ŁÓDŹ ŒUVRE Ÿ") == "łódź œuvre ÿ");
+  REQUIRE(String::fold("ΑΒΓ Ά ΏΣ") == "αβγ ά ώσ");
+  REQUIRE(String::fold("ПРИВЕТ ЁЖ Ѣ") == "привет ёж ѣ");
+  REQUIRE(String::fold("日本語") == "日本語");
+  REQUIRE(String::fold("\xC3") == "\xC3"); // truncated sequence
+}
+
 TEST_CASE("pretty-print numbers", M) {
   REQUIRE(String::number(42'000'000) == "42,000,000");
 }
@@ -76,3 +76,10 @@ TEST_CASE("compare times", M) {
     REQUIRE(Time(2016, 2, 3) >= Time(2015, 2, 3));
   }
 }
+
+TEST_CASE("time sort key", M) {
+  REQUIRE(Time(2016,1,2,3,4,5).sortKey() == 20160102030405);
+  REQUIRE(Time(2016,1,2,3,4,5).sortKey() < Time(2016,1,2,3,4,6).sortKey());
+  REQUIRE(Time(2015,12,31,23,59,59).sortKey() < Time(2016,1,1).sortKey());
+  REQUIRE(Time().sortKey() < Time(2016,1,1).sortKey());
+}
@@ -190,6 +190,24 @@ TEST_CASE("prerelease versions", M) {
   }
 }
 
+TEST_CASE("version sort key", M) {
+  const auto sign = [](const int n) { return (n > 0) - (n < 0); };
+
+  const vector<VersionName> versions{
+    VersionName(), {"0"}, {"0.9"}, {"1"}, {"1.0.0.0"}, {"1.0a"}, {"1.0a.2"},
+    {"1.0b.1"}, {"1.0-beta1"}, {"1.0b"}, {"1.0.1"}, {"1.0.0.1"}, {"1.0.0a"},
+    {"1.a"}, {"1.5"}, {"1.10"}, {"1.0.5"}, {"1.alpha"}, {"1.alphab"}, {"2"},
+    {"65535"}, {"1.0.0.0.b"},
+  };
+
+  for(const VersionName &a : versions) {
+    for(const VersionName &b : versions) {
+      INFO(a.toString() << " vs " << b.toString());
+      REQUIRE(sign(a.sortKey().compare(b.sortKey())) == sign(a.compare(b)));
+    }
+  }
+}
+
 TEST_CASE("copy version constructor", M) {
   const VersionName original("1.1test");
   const VersionName copy(original);